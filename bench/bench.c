@@ -0,0 +1,171 @@
+// bench/bench.c
+#include "uart.h"
+#include "board.h"
+#include "scheduler.h"
+#include "sync.h"
+#include "stats.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/*-----------------------------------------------------------------
+  Kernel microbenchmarks (`make bench`)
+
+  One result per line, everything else on the console is noise:
+    BENCH <name> iters=<n> total_us=<t> ns_per_op=<x> [max_us=<m>]
+  followed by "BENCH DONE". Times come from timestamp_us() (Timer1,
+  1 us resolution; the ARM926EJ-S has no cycle counter), so per-op
+  figures are averages over many iterations.
+
+  `make perf` runs the image headless with -icount (bench/perf.sh) and
+  checks these lines against bench/baseline-<profile>.txt, recording
+  that file on the first run.
+-----------------------------------------------------------------*/
+#define READY_ROUNDS    (1000U)
+#define SWITCH_ITERS    (10000U)
+#define WAKE_ITERS      (64U)
+#define UART_LINES      (32U)
+
+#define PRIO_BENCH      (0)     // controller, outranks everything below
+#define PRIO_PEER       (1)
+#define PRIO_SLEEPER    (2)
+
+static sem_t done     = SEM_INIT(0);
+static sem_t ping     = SEM_INIT(0);
+static sem_t pong     = SEM_INIT(0);
+static volatile int sleepers_stop;
+
+/* --- Reporting --- */
+static void report(const char *name, uint32_t variant, uint32_t iters, uint32_t total_us,
+                   uint32_t max_us) {
+    uart_puts("BENCH ");
+    uart_puts(name);
+    if (variant != (uint32_t)-1) uart_putdec(variant);
+    uart_puts(" iters=");
+    uart_putdec(iters);
+    uart_puts(" total_us=");
+    uart_putdec(total_us);
+    uart_puts(" ns_per_op=");
+    uart_putdec((uint32_t)((uint64_t)total_us * 1000U / iters));
+    if (max_us) {
+        uart_puts(" max_us=");
+        uart_putdec(max_us);
+    }
+    uart_puts("\r\n");
+}
+
+/* --- Ping-pong through yield(): two equal-priority peers --- */
+static void yield_peer(void) {
+    for (uint32_t i = 0; i < SWITCH_ITERS; i++) yield();
+    sem_post(&done);
+}
+
+/* --- Ping-pong through semaphores: every hand-off blocks one side --- */
+static void sem_ping(void) {
+    for (uint32_t i = 0; i < SWITCH_ITERS; i++) {
+        sem_post(&pong);
+        sem_wait(&ping);
+    }
+    sem_post(&done);
+}
+
+static void sem_pong(void) {
+    for (uint32_t i = 0; i < SWITCH_ITERS; i++) {
+        sem_wait(&pong);
+        sem_post(&ping);
+    }
+    sem_post(&done);
+}
+
+static void bench_pair(const char *name, void (*a)(void), void (*b)(void)) {
+    task_create(a, NULL, 0, PRIO_PEER);
+    task_create(b, NULL, 0, PRIO_PEER);
+
+    // The peers only run once we block here
+    uint32_t start = timestamp_us();
+    sem_wait(&done);
+    sem_wait(&done);
+    uint32_t elapsed = timestamp_us() - start;
+
+    report(name, (uint32_t)-1, 2 * SWITCH_ITERS, elapsed, 0);
+}
+
+/* --- Tick wakeup latency with n other tasks woken by the same tick --- */
+static void sleeper(void) {
+    while (!sleepers_stop) sleep(1);
+}
+
+static void bench_wake(uint32_t sleepers) {
+    sleepers_stop = 0;
+    for (uint32_t i = 0; i < sleepers; i++) task_create(sleeper, NULL, 0, PRIO_SLEEPER);
+
+    uint32_t total = 0, max = 0;
+    sleep(1);   // line up with the sleepers
+    for (uint32_t i = 0; i < WAKE_ITERS; i++) {
+        sleep(1);
+        uint32_t lat = timestamp_us() - tick_timer_expiry();
+        total += lat;
+        if (lat > max) max = lat;
+    }
+
+    // Let the sleepers run off the end of their entry (task_exit)
+    sleepers_stop = 1;
+    sleep(2);
+
+    report("wake_latency_s", sleepers, WAKE_ITERS, total, max);
+}
+
+/* --- UART: polled FIFO writes vs. the interrupt-driven TX ring --- */
+static const char uart_line[] = "...............................................................\r\n";
+
+static void bench_uart(void) {
+    const uint32_t len = sizeof(uart_line) - 1;
+
+    uint32_t start = timestamp_us();
+    for (uint32_t i = 0; i < UART_LINES; i++) uart_puts(uart_line);
+    report("uart_polled_byte", (uint32_t)-1, UART_LINES * len, timestamp_us() - start, 0);
+
+    start = timestamp_us();
+    for (uint32_t i = 0; i < UART_LINES; i++) uart_write_blocking(uart_line, len);
+    report("uart_ring_byte", (uint32_t)-1, UART_LINES * len, timestamp_us() - start, 0);
+}
+
+/*-----------------------------------------------------------------
+  Tasks
+-----------------------------------------------------------------*/
+static void bench_main(void) {
+    bench_pair("switch_yield", yield_peer, yield_peer);
+    bench_pair("switch_sem", sem_ping, sem_pong);
+
+    bench_wake(0);
+    bench_wake(4);
+    bench_wake(16);
+
+    bench_uart();
+
+    sched_stats_dump();
+    uart_puts("BENCH DONE\r\n");
+
+    while (1) sleep(1000);
+}
+
+/*-----------------------------------------------------------------
+  Main
+-----------------------------------------------------------------*/
+int main(void) {
+    uart_init();
+    uart_puts("Booting bench...\r\n");
+
+    board_init();
+    scheduler_init(NULL);
+
+    // Runs on the bare ready lists, before any task exists
+    report("ready_enqueue_pick", (uint32_t)-1, READY_ROUNDS * 32,
+           sched_bench_ready(READY_ROUNDS), 0);
+
+    task_create(bench_main, NULL, 0, PRIO_BENCH);
+
+    scheduler_start();
+
+    while (1);
+    return 0;
+}
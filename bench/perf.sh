@@ -0,0 +1,112 @@
+#!/bin/sh
+#-----------------------------------------------------------------
+#  Headless benchmark run with a baseline check (`make perf`)
+#
+#    bench/perf.sh <bench image> <baseline file> [update]
+#
+#  Boots the image in QEMU with the serial port on stdio and
+#  -icount shift=0: one instruction per virtual nanosecond, so Timer1
+#  (timestamp_us()) counts instructions and the results repeat from
+#  run to run. The "BENCH ..." lines are then compared by name with
+#  the baseline file: a ns_per_op or max_us more than PERF_TOLERANCE
+#  percent above it is a regression (exit status 1). With "update",
+#  or when the baseline file does not exist yet, the results become
+#  the baseline instead (commit it so later runs compare against it).
+#
+#  Environment: QEMU (qemu-system-arm), PERF_TOLERANCE (10),
+#  PERF_TIMEOUT (seconds until "BENCH DONE", 120).
+#-----------------------------------------------------------------
+set -u
+
+image=$1
+baseline=$2
+mode=${3:-check}
+
+QEMU=${QEMU:-qemu-system-arm}
+PERF_TOLERANCE=${PERF_TOLERANCE:-10}
+PERF_TIMEOUT=${PERF_TIMEOUT:-120}
+
+log=$(mktemp)
+results=$(mktemp)
+trap 'rm -f "$log" "$results"' EXIT
+
+# --- Run until the bench prints BENCH DONE (it then sleeps forever) ---
+$QEMU -M versatilepb -m 32M -cpu arm926 -icount shift=0 \
+    -nographic -monitor none -kernel "$image" > "$log" 2>&1 &
+pid=$!
+
+elapsed=0
+while ! grep -q "^BENCH DONE" "$log"; do
+    if ! kill -0 "$pid" 2>/dev/null; then
+        cat "$log"
+        echo "perf: qemu exited before BENCH DONE" >&2
+        exit 2
+    fi
+    if [ "$elapsed" -ge "$PERF_TIMEOUT" ]; then
+        kill "$pid"
+        cat "$log"
+        echo "perf: no BENCH DONE after ${PERF_TIMEOUT}s" >&2
+        exit 2
+    fi
+    sleep 1
+    elapsed=$((elapsed + 1))
+done
+kill "$pid" 2>/dev/null
+wait "$pid" 2>/dev/null
+
+tr -d '\r' < "$log" | grep "^BENCH " | grep -v "^BENCH DONE" > "$results"
+
+if [ "$mode" = update ]; then
+    cp "$results" "$baseline"
+    echo "perf: baseline $baseline updated ($(wc -l < "$results") results)"
+    exit 0
+fi
+
+if [ ! -f "$baseline" ]; then
+    cat "$results"
+    cp "$results" "$baseline"
+    echo "perf: no baseline yet, recorded $baseline ($(wc -l < "$results") results), commit it"
+    exit 0
+fi
+
+# --- Compare: one line per result, regressions flagged ---
+awk -v tol="$PERF_TOLERANCE" '
+    function field(line, key,    i, n, kv) {
+        n = split(line, kv, " ")
+        for (i = 2; i <= n; i++)
+            if (index(kv[i], key "=") == 1) return substr(kv[i], length(key) + 2)
+        return ""
+    }
+    function check(name, key, base, cur,    pct) {
+        if (base == "" || cur == "") return
+        pct = base > 0 ? (cur - base) * 100 / base : (cur > 0 ? 100 : 0)
+        printf "  %-22s %-9s %10d %10d %+7.1f%%", name, key, base, cur, pct
+        if (pct > tol) {
+            printf "  REGRESSION"
+            bad++
+        }
+        printf "\n"
+    }
+    FNR == NR { base[$2] = $0; next }
+    {
+        seen[$2] = 1
+        if (!($2 in base)) {
+            printf "  %-22s new, not in the baseline\n", $2
+            next
+        }
+        check($2, "ns_per_op", field(base[$2], "ns_per_op"), field($0, "ns_per_op"))
+        check($2, "max_us", field(base[$2], "max_us"), field($0, "max_us"))
+    }
+    END {
+        for (name in base)
+            if (!(name in seen)) {
+                printf "  %-22s missing from this run\n", name
+                bad++
+            }
+        if (bad) {
+            printf "perf: %d regression(s) beyond %s%%\n", bad, tol
+            exit 1
+        }
+        printf "perf: within %s%% of the baseline\n", tol
+    }
+' "$baseline" "$results"
@@ -0,0 +1,123 @@
+// drivers/board.c
+#include "board.h"
+#include "irq.h"
+#include "uart.h"
+#include "scheduler.h"
+#include "stats.h"
+
+/*-----------------------------------------------------------------
+  Hardware definitions
+-----------------------------------------------------------------*/
+#define TIMER0_BASE     (0x101E2000)
+#define TIMER0_LOAD     (*(volatile unsigned int*)(TIMER0_BASE + 0x00))
+#define TIMER0_VALUE    (*(volatile unsigned int*)(TIMER0_BASE + 0x04))
+#define TIMER0_CONTROL  (*(volatile unsigned int*)(TIMER0_BASE + 0x08))
+#define TIMER0_INTCLR   (*(volatile unsigned int*)(TIMER0_BASE + 0x0C))
+#define TIMER0_RIS      (*(volatile unsigned int*)(TIMER0_BASE + 0x10))
+#define TIMER0_MIS      (*(volatile unsigned int*)(TIMER0_BASE + 0x14))
+#define TIMER0_BGLOAD   (*(volatile unsigned int*)(TIMER0_BASE + 0x18))
+#define TIMER_CLK_HZ    (1000000)  // TIMCLK feeding both timers
+#define TIMER0_IRQ      (4U)       // VIC line
+
+// Second half of the dual timer: free-running timestamp, no interrupt
+#define TIMER1_BASE     (TIMER0_BASE + 0x20)
+#define TIMER1_LOAD     (*(volatile unsigned int*)(TIMER1_BASE + 0x00))
+#define TIMER1_VALUE    (*(volatile unsigned int*)(TIMER1_BASE + 0x04))
+#define TIMER1_CONTROL  (*(volatile unsigned int*)(TIMER1_BASE + 0x08))
+
+/* VIC priorities (vectored slots, 0 = highest) */
+#define TIMER0_IRQ_PRIO (0U)
+#define UART0_IRQ_PRIO  (1U)
+
+/*-----------------------------------------------------------------
+  Tick interrupt
+-----------------------------------------------------------------*/
+static uint32_t tick_counts = TIMER_CLK_HZ / SCHED_TICK_HZ_DEFAULT; // per tick
+static uint32_t tick_expiry; // timestamp_us() of the last serviced expiry
+
+static void timer0_irq(void) {
+    // Counter reloaded at expiry: LOAD - VALUE is the time since then
+    tick_expiry = timestamp_us() - (TIMER0_LOAD - TIMER0_VALUE);
+    STATS_IRQ_ENTER(tick_expiry);
+
+    // Clear timer0 interrupt in the timer peripheral
+    TIMER0_INTCLR = 1;
+    // May select another task; the switch happens on IRQ exit
+    scheduler_tick();
+}
+
+/*-----------------------------------------------------------------
+  Tick timer (tickless support)
+-----------------------------------------------------------------*/
+void tick_timer_init(uint32_t hz) {
+    tick_counts = TIMER_CLK_HZ / hz;
+
+    // Periodic interrupt every tick_counts timer clocks
+    TIMER0_CONTROL = 0x00;     // Stop timer
+    TIMER0_LOAD    = tick_counts;
+    TIMER0_INTCLR  = 0;        // Clear any pending interrupt
+    TIMER0_CONTROL = 0xE2;     // Enable: Timer, Periodic, IRQ
+}
+
+uint32_t tick_timer_expiry(void) {
+    return tick_expiry;
+}
+
+uint32_t tick_timer_elapsed_us(void) {
+    uint32_t period = TIMER0_LOAD;
+    uint32_t value = TIMER0_VALUE;
+    uint32_t expired = 0;
+
+    // Same sampling as tick_timer_set(), without touching the timer
+    if (TIMER0_RIS & 1) {
+        expired = period;
+        value = TIMER0_VALUE;
+    }
+    return (expired + period - value) / (TIMER_CLK_HZ / 1000000);
+}
+
+uint32_t tick_timer_set(uint32_t ticks) {
+    uint32_t period = TIMER0_LOAD;  // reads back the reload value
+    uint32_t whole = 0;
+
+    // Sample, then look for an expiry: if one is pending it may have come
+    // after the sample, so count that period and sample the new one again
+    uint32_t value = TIMER0_VALUE;
+    if (TIMER0_RIS & 1) {
+        whole = period / tick_counts;
+        value = TIMER0_VALUE;
+    }
+
+    // Counts since the current period started (Timer0 counts down)
+    uint32_t elapsed = period - value;
+    whole += elapsed / tick_counts;
+    uint32_t frac = elapsed % tick_counts;
+
+    TIMER0_LOAD   = ticks * tick_counts - frac; // restarts the counter
+    TIMER0_BGLOAD = ticks * tick_counts;        // reload for later periods
+
+    // Accounted for above, along with one racing the reprogramming
+    TIMER0_INTCLR = 1;
+    return whole;
+}
+
+/*-----------------------------------------------------------------
+  Timestamp (Timer1 counts down from 0xFFFFFFFF at 1 MHz)
+-----------------------------------------------------------------*/
+uint32_t timestamp_us(void) {
+    return ~TIMER1_VALUE;
+}
+
+/*-----------------------------------------------------------------
+  Init
+-----------------------------------------------------------------*/
+void board_init(void) {
+    // Timer0 (the tick) is started by scheduler_init() via tick_timer_init()
+
+    // Timer1 (timestamp_us) already runs: reset starts it as the boot clock
+
+    // Vectored dispatch for our lines
+    irq_init();
+    irq_register(TIMER0_IRQ, timer0_irq, TIMER0_IRQ_PRIO);
+    irq_register(UART0_IRQ, uart_irq_handler, UART0_IRQ_PRIO);
+}
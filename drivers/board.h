@@ -0,0 +1,22 @@
+// drivers/board.h
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <stdint.h>
+
+/*
+ * versatilepb board support: Timer0 drives the scheduler tick, Timer1
+ * runs free as timestamp_us(), the tick and UART0 are registered with the
+ * VIC dispatcher (irq.h). The tick_timer_set()/timestamp_us() hooks used
+ * by the kernel are declared in scheduler.h.
+ */
+
+/* Start the timestamp timer and register the board's VIC lines (the tick
+   timer is started by scheduler_init()). Call once at boot after
+   uart_init(). */
+void board_init(void);
+
+/* timestamp_us() at which the most recently serviced tick expired. */
+uint32_t tick_timer_expiry(void);
+
+#endif
@@ -0,0 +1,56 @@
+// drivers/fiq.c
+#include "fiq.h"
+
+/* --- PL190 registers --- */
+#define VIC_BASE        (0x10140000)
+#define VICINTSELECT    (*(volatile unsigned int*)(VIC_BASE + 0x00C))
+#define VICINTENABLE    (*(volatile unsigned int*)(VIC_BASE + 0x010))
+#define VICINTENCLEAR   (*(volatile unsigned int*)(VIC_BASE + 0x014))
+#define VICSOFTINT      (*(volatile unsigned int*)(VIC_BASE + 0x018))
+#define VICSOFTINTCLEAR (*(volatile unsigned int*)(VIC_BASE + 0x01C))
+
+static FIQ_HANDLER void fiq_spurious(void) {
+}
+
+/* Loaded by the FIQ vector in startup.S */
+fiq_handler_t volatile fiq_vector = fiq_spurious;
+
+static uint32_t fiq_line = IRQ_LINES;      // none
+static irq_handler_t signal_handler;
+
+int fiq_register(uint32_t line, fiq_handler_t handler) {
+    if (line >= IRQ_LINES || !handler) return -1;
+
+    fiq_unregister();
+
+    VICINTENCLEAR = 1u << line;
+    fiq_vector = handler;
+    fiq_line = line;
+    VICINTSELECT |= 1u << line;
+    VICINTENABLE = 1u << line;
+    return 0;
+}
+
+void fiq_unregister(void) {
+    if (fiq_line >= IRQ_LINES) return;
+
+    VICINTENCLEAR = 1u << fiq_line;
+    VICINTSELECT &= ~(1u << fiq_line);
+    fiq_vector = fiq_spurious;
+    fiq_line = IRQ_LINES;
+}
+
+/* --- FIQ -> IRQ signalling through the VIC software interrupt --- */
+static void fiq_signal_irq(void) {
+    VICSOFTINTCLEAR = 1u << FIQ_SIGNAL_LINE;
+    if (signal_handler) signal_handler();
+}
+
+int fiq_signal_register(irq_handler_t handler, uint32_t priority) {
+    signal_handler = handler;
+    return irq_register(FIQ_SIGNAL_LINE, fiq_signal_irq, priority);
+}
+
+void fiq_signal(void) {
+    VICSOFTINT = 1u << FIQ_SIGNAL_LINE;
+}
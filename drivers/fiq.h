@@ -0,0 +1,50 @@
+// drivers/fiq.h
+#ifndef FIQ_H
+#define FIQ_H
+
+#include <stdint.h>
+#include "irq.h"
+
+/*
+ * FIQ fast path for one dedicated low-latency source.
+ *
+ * The selected VIC line is routed to FIQ (VICINTSELECT), which is never
+ * masked by irq_save() and preempts tasks and IRQ handlers
+ * alike. The vector enters the handler through the banked r8 without
+ * saving anything; declare the handler with FIQ_HANDLER so the compiler
+ * saves only what it uses (r8-r12 are banked, so a short handler saves
+ * almost nothing) and returns from the exception itself.
+ *
+ * Because IRQ masking does not stop it, an FIQ handler must not touch
+ * kernel objects. To hand work to a task it publishes data lock-free
+ * (queue_commit_fiq()) and calls fiq_signal(), which raises a software
+ * interrupt on FIQ_SIGNAL_LINE; the signal handler then runs as an
+ * ordinary IRQ and may use the *_isr calls (sem_post_isr(),
+ * queue_notify_isr(), ...).
+ */
+
+#ifdef __arm__
+#define FIQ_HANDLER __attribute__((interrupt("FIQ")))
+#else
+#define FIQ_HANDLER
+#endif
+
+/* VIC software-interrupt line used by fiq_signal() (versatilepb SOFTINT) */
+#define FIQ_SIGNAL_LINE (1U)
+
+typedef void (*fiq_handler_t)(void);
+
+/* Route a VIC line to FIQ and run handler on it, replacing the previous
+   FIQ source. Returns 0, or -1 for a bad line. */
+int fiq_register(uint32_t line, fiq_handler_t handler);
+
+/* Give the FIQ line back to the IRQ side (disabled). */
+void fiq_unregister(void);
+
+/* Install the IRQ-level handler run after fiq_signal(). */
+int fiq_signal_register(irq_handler_t handler, uint32_t priority);
+
+/* From the FIQ handler: request the signal handler (coalesces). */
+void fiq_signal(void);
+
+#endif
@@ -0,0 +1,107 @@
+// drivers/irq.c
+#include "irq.h"
+#include "stats.h"
+
+/* --- PL190 registers --- */
+#define VIC_BASE        (0x10140000)
+#define VICIRQSTATUS    (*(volatile unsigned int*)(VIC_BASE + 0x000))
+#define VICINTENABLE    (*(volatile unsigned int*)(VIC_BASE + 0x010))
+#define VICINTENCLEAR   (*(volatile unsigned int*)(VIC_BASE + 0x014))
+#define VICVECTADDR     (*(volatile unsigned int*)(VIC_BASE + 0x030))
+#define VICDEFVECTADDR  (*(volatile unsigned int*)(VIC_BASE + 0x034))
+#define VICVECTADDRn(n) (*(volatile unsigned int*)(VIC_BASE + 0x100 + 4 * (n)))
+#define VICVECTCNTLn(n) (*(volatile unsigned int*)(VIC_BASE + 0x200 + 4 * (n)))
+
+#define VECTCNTL_ENABLE (1u << 5)
+
+/*
+ * The VIC's vector address registers hold any 32-bit value; they point
+ * at these entries so one read yields both the handler and its flags.
+ */
+typedef struct {
+    irq_handler_t handler;
+    uint32_t flags;             // IRQ_NEST
+} irq_vector_t;
+
+static irq_vector_t slots[IRQ_VECTORED];   // vectored, by priority
+static irq_vector_t lines[IRQ_LINES];      // non-vectored, by line
+static uint8_t line_slot[IRQ_LINES];       // vectored slot + 1, 0 = none
+static uint32_t vectored_mask;             // lines owning a slot
+
+/* Run fn in SVC mode with IRQs enabled (startup.S) */
+extern void irq_call_nested(irq_handler_t fn);
+
+static inline void irq_run(const irq_vector_t *v) {
+    if (v->flags & IRQ_NEST) irq_call_nested(v->handler);
+    else v->handler();
+}
+
+/* --- Default vector: pending non-vectored lines, lowest number first --- */
+static void irq_dispatch_default(void) {
+    uint32_t pending = VICIRQSTATUS & ~vectored_mask;
+
+    while (pending) {
+        uint32_t line = 31 - __builtin_clz(pending & -pending);
+        pending &= pending - 1;
+        if (lines[line].handler) irq_run(&lines[line]);
+    }
+}
+
+static irq_vector_t default_vector = { irq_dispatch_default, 0 };
+
+/* --- Called from the IRQ entry in startup.S --- */
+void irq_handler(void) {
+    // Reading the vector acknowledges it: the VIC now masks this
+    // priority and everything below until the write back
+    const irq_vector_t *v = (const irq_vector_t *)VICVECTADDR;
+    irq_run(v);
+    VICVECTADDR = 0;
+
+    STATS_IRQ_EXIT();
+}
+
+void irq_init(void) {
+    VICINTENCLEAR = 0xFFFFFFFF;
+    for (uint32_t n = 0; n < IRQ_VECTORED; n++) VICVECTCNTLn(n) = 0;
+    VICDEFVECTADDR = (uint32_t)&default_vector;
+}
+
+int irq_register(uint32_t line, irq_handler_t handler, uint32_t priority) {
+    uint32_t slot = priority & 0xFF;
+    uint32_t flags = priority & IRQ_NEST;
+
+    if (line >= IRQ_LINES || !handler) return -1;
+    irq_unregister(line);
+
+    if (slot < IRQ_VECTORED) {
+        if (slots[slot].handler) return -1;
+        slots[slot].handler = handler;
+        slots[slot].flags = flags;
+        VICVECTADDRn(slot) = (uint32_t)&slots[slot];
+        VICVECTCNTLn(slot) = VECTCNTL_ENABLE | line;
+        line_slot[line] = (uint8_t)(slot + 1);
+        vectored_mask |= 1u << line;
+    } else {
+        lines[line].handler = handler;
+        lines[line].flags = flags;
+    }
+
+    // Last, so the line never fires into a half-written entry
+    VICINTENABLE = 1u << line;
+    return 0;
+}
+
+void irq_unregister(uint32_t line) {
+    if (line >= IRQ_LINES) return;
+
+    VICINTENCLEAR = 1u << line;
+
+    if (line_slot[line]) {
+        uint32_t slot = line_slot[line] - 1U;
+        VICVECTCNTLn(slot) = 0;
+        slots[slot].handler = 0;
+        line_slot[line] = 0;
+        vectored_mask &= ~(1u << line);
+    }
+    lines[line].handler = 0;
+}
@@ -0,0 +1,45 @@
+// drivers/irq.h
+#ifndef IRQ_H
+#define IRQ_H
+
+#include <stdint.h>
+
+/*
+ * PL190 VIC interrupt dispatch.
+ *
+ * Lines registered at priorities 0..15 get one of the VIC's vectored
+ * slots: on an IRQ the VIC hands irq_handler() the highest-priority
+ * pending slot directly (no status scan) and holds off equal and lower
+ * priorities until the handler is done. Priorities from IRQ_PRIORITY_LOW
+ * on share the non-vectored default path, scanned by line number after
+ * all vectored lines.
+ *
+ * By default a handler runs in IRQ mode with IRQs masked, like the rest
+ * of the kernel's ISR paths (the *_isr calls rely on that). OR IRQ_NEST
+ * into the priority to run it with IRQs enabled instead, so that a
+ * higher-priority line can preempt it; such a handler must wrap any
+ * kernel call in irq_save()/irq_restore() (os/critical.h).
+ */
+
+#define IRQ_LINES        (32U)
+#define IRQ_VECTORED     (16U)          // hardware vector slots
+#define IRQ_PRIORITY_LOW (IRQ_VECTORED) // non-vectored, below all slots
+#define IRQ_NEST         (1U << 8)      // priority flag: preemptible handler
+
+typedef void (*irq_handler_t)(void);
+
+/* Point the VIC's default vector at the scanning dispatcher. Call once
+   at boot, before registering handlers. */
+void irq_init(void);
+
+/*
+ * Install the handler for a VIC line and enable it, replacing any
+ * earlier registration of that line. Boot time or a single task.
+ * Returns 0, or -1 for a bad line or an already used vectored slot.
+ */
+int irq_register(uint32_t line, irq_handler_t handler, uint32_t priority);
+
+/* Disable a line and drop its handler. */
+void irq_unregister(uint32_t line);
+
+#endif
@@ -1,12 +1,177 @@
 // drivers/uart.c
 #include "uart.h"
+#include "scheduler.h"
+#include "kernel.h"
+#include "klib.h"
+#include "critical.h"
 
-#define UART0_DR (*(volatile unsigned int*)0x101f1000)
+/* --- PL011 registers --- */
+#define UART0_BASE  (0x101f1000)
+#define UART0_DR    (*(volatile unsigned int*)(UART0_BASE + 0x00))
+#define UART0_FR    (*(volatile unsigned int*)(UART0_BASE + 0x18))
+#define UART0_LCRH  (*(volatile unsigned int*)(UART0_BASE + 0x2C))
+#define UART0_CR    (*(volatile unsigned int*)(UART0_BASE + 0x30))
+#define UART0_IFLS  (*(volatile unsigned int*)(UART0_BASE + 0x34))
+#define UART0_IMSC  (*(volatile unsigned int*)(UART0_BASE + 0x38))
+#define UART0_MIS   (*(volatile unsigned int*)(UART0_BASE + 0x40))
+#define UART0_ICR   (*(volatile unsigned int*)(UART0_BASE + 0x44))
+
+#define FR_RXFE     (1u << 4)
+#define FR_TXFF     (1u << 5)
+#define LCRH_FEN    (1u << 4)
+#define LCRH_WLEN8  (3u << 5)
+#define CR_UARTEN   (1u << 0)
+#define CR_TXE      (1u << 8)
+#define CR_RXE      (1u << 9)
+#define INT_RX      (1u << 4)
+#define INT_TX      (1u << 5)
+#define INT_RT      (1u << 6)
+
+/* --- Ring buffers (power-of-two sizes, free-running indices) --- */
+#define TX_RING_SIZE 1024U
+#define RX_RING_SIZE 256U
+
+static char tx_ring[TX_RING_SIZE];
+static volatile uint32_t tx_head; /* written by tasks */
+static volatile uint32_t tx_tail; /* written by the ISR */
+
+/* uart_write_blocking() callers waiting for ring space */
+static wait_queue_t tx_waiters = WAIT_QUEUE_INIT;
+static uint32_t tx_need;           /* least room one of them waits for, 0 = none */
+
+static char rx_ring[RX_RING_SIZE];
+static volatile uint32_t rx_head; /* written by the ISR */
+static volatile uint32_t rx_tail; /* written by readers */
+
+void uart_init(void) {
+    UART0_CR   = 0;
+    UART0_LCRH = LCRH_FEN | LCRH_WLEN8;
+    UART0_IFLS = 0;                  // TX and RX at 1/8 FIFO
+    UART0_ICR  = 0x7FF;
+    UART0_IMSC = INT_RX | INT_RT;    // TX enabled on demand
+    UART0_CR   = CR_UARTEN | CR_TXE | CR_RXE;
+}
 
 void uart_putc(char c) {
+    while (UART0_FR & FR_TXFF);
     UART0_DR = c;
 }
 
 void uart_puts(const char* s) {
     while (*s) uart_putc(*s++);
-}
\ No newline at end of file
+}
+
+void uart_puthex(uint32_t value) {
+    static const char hexchars[] = "0123456789ABCDEF";
+    char buf[11]; // "0x" + 8 digits + null
+    buf[0] = '0';
+    buf[1] = 'x';
+    for (int i = 0; i < 8; i++) {
+        buf[9 - i] = hexchars[value & 0xF];
+        value >>= 4;
+    }
+    buf[10] = '\0';
+    uart_puts(buf);
+}
+
+void uart_putdec(uint32_t value) {
+    char buf[KLIB_UTOA_MAX];
+    klib_utoa(value, buf);
+    uart_puts(buf);
+}
+
+/* --- Move queued bytes into the TX FIFO (IRQs masked) --- */
+static void uart_tx_fill(void) {
+    while (tx_tail != tx_head && !(UART0_FR & FR_TXFF)) {
+        UART0_DR = tx_ring[tx_tail & (TX_RING_SIZE - 1)];
+        tx_tail++;
+    }
+
+    // Only take TX interrupts while there is something left to send
+    if (tx_tail != tx_head) UART0_IMSC |= INT_TX;
+    else UART0_IMSC &= ~INT_TX;
+}
+
+uint32_t uart_write(const char *buf, uint32_t len) {
+    irq_flags_t flags = irq_save();
+
+    uint32_t room = TX_RING_SIZE - (tx_head - tx_tail);
+    if (len > room) len = room;
+
+    for (uint32_t i = 0; i < len; i++)
+        tx_ring[(tx_head + i) & (TX_RING_SIZE - 1)] = buf[i];
+    tx_head += len;
+
+    uart_tx_fill();
+    irq_restore(flags);
+    return len;
+}
+
+void uart_write_blocking(const char *buf, uint32_t len) {
+    while (len) {
+        // Wait for room for the whole buffer when it can fit at all,
+        // so lines written by different tasks never interleave.
+        uint32_t need = len < TX_RING_SIZE ? len : TX_RING_SIZE;
+
+        irq_flags_t flags = irq_save();
+        if (TX_RING_SIZE - (tx_head - tx_tail) < need && sched_current()) {
+            if (!tx_need || need < tx_need) tx_need = need;
+            sched_block(&tx_waiters);   // woken by the TX interrupt
+            irq_restore(flags);
+            continue;
+        }
+
+        uint32_t n = uart_write(buf, len);
+        irq_restore(flags);
+        buf += n;
+        len -= n;
+    }
+}
+
+/* --- TX drained: wake the writers once the smallest request fits (ISR) --- */
+static void uart_tx_wake(void) {
+    if (!tx_need || TX_RING_SIZE - (tx_head - tx_tail) < tx_need) return;
+
+    // Those that still do not fit block again and set tx_need anew
+    tx_need = 0;
+    task_t *t;
+    while ((t = wait_queue_pop(&tx_waiters))) sched_wake(t);
+    sched_preempt();
+}
+
+int uart_getc(void) {
+    if (rx_tail == rx_head) return -1;
+
+    char c = rx_ring[rx_tail & (RX_RING_SIZE - 1)];
+    rx_tail++;
+    return (unsigned char)c;
+}
+
+uint32_t uart_read(char *buf, uint32_t len) {
+    uint32_t n = 0;
+    int c;
+    while (n < len && (c = uart_getc()) >= 0)
+        buf[n++] = (char)c;
+    return n;
+}
+
+void uart_irq_handler(void) {
+    uint32_t mis = UART0_MIS;
+
+    if (mis & (INT_RX | INT_RT)) {
+        while (!(UART0_FR & FR_RXFE)) {
+            char c = (char)UART0_DR;
+            if (rx_head - rx_tail < RX_RING_SIZE) {  // drop on overflow
+                rx_ring[rx_head & (RX_RING_SIZE - 1)] = c;
+                rx_head++;
+            }
+        }
+        UART0_ICR = INT_RX | INT_RT;
+    }
+
+    if (mis & INT_TX) {
+        UART0_ICR = INT_TX;
+        uart_tx_fill();
+        uart_tx_wake();
+    }
+}
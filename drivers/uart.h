@@ -2,7 +2,34 @@
 #ifndef UART_H
 #define UART_H
 
+#include <stdint.h>
+
+/* UART0 line on the VIC */
+#define UART0_IRQ (12U)
+
+/* Enable FIFOs and RX interrupts. Call once at boot, before IRQs. */
+void uart_init(void);
+
+/* Polled output: safe from any context, blocks on the TX FIFO. */
 void uart_putc(char c);
 void uart_puts(const char* s);
+void uart_puthex(uint32_t value);   /* "0x" + 8 digits */
+void uart_putdec(uint32_t value);
+
+/*
+ * Buffered output (task context): bytes go into a TX ring drained by the
+ * UART interrupt. uart_write() queues what fits and returns the count;
+ * uart_write_blocking() blocks the caller on a wait queue until the TX
+ * interrupt has drained enough of the ring to queue the whole buffer.
+ */
+uint32_t uart_write(const char *buf, uint32_t len);
+void uart_write_blocking(const char *buf, uint32_t len);
+
+/* Buffered input: returns -1 / 0 bytes when nothing was received. */
+int uart_getc(void);
+uint32_t uart_read(char *buf, uint32_t len);
+
+/* UART0 interrupt handler, registered on UART0_IRQ by board_init(). */
+void uart_irq_handler(void);
 
 #endif
@@ -1,62 +1,22 @@
 #include "uart.h"
+#include "board.h"
 #include "scheduler.h"
 #include <stdint.h>
 
 /*-----------------------------------------------------------------
-  Hardware definitions
+  Tasks (stacks come from the kernel heap, sizes in words)
 -----------------------------------------------------------------*/
-#define TIMER0_BASE     (0x101E2000)
-#define TIMER0_LOAD     (*(volatile unsigned int*)(TIMER0_BASE + 0x00))
-#define TIMER0_VALUE    (*(volatile unsigned int*)(TIMER0_BASE + 0x04))
-#define TIMER0_CONTROL  (*(volatile unsigned int*)(TIMER0_BASE + 0x08))
-#define TIMER0_INTCLR   (*(volatile unsigned int*)(TIMER0_BASE + 0x0C))
-#define TIMER0_RIS      (*(volatile unsigned int*)(TIMER0_BASE + 0x10))
-#define TIMER0_MIS      (*(volatile unsigned int*)(TIMER0_BASE + 0x14))
-#define TIMER0_BGLOAD   (*(volatile unsigned int*)(TIMER0_BASE + 0x18))
-#define TIMER0_MS       (1000000)  // 1 ms = 1000 us
-#define TIMER0_IRQ_BIT  (1u << 4)  // check your SoC manual for exact mapping
+#define STACK_SIZE      (1024 / 4)
 
-#define NVIC_BASE       (0x10140000)
-#define VICIRQSTATUS    (*(volatile unsigned int*)(NVIC_BASE + 0x000))
-#define VICFIQSTATUS    (*(volatile unsigned int*)(NVIC_BASE + 0x004))
-#define VICRAWINTR      (*(volatile unsigned int*)(NVIC_BASE + 0x008))
-#define VICINTSELECT    (*(volatile unsigned int*)(NVIC_BASE + 0x00C))
-#define VICINTENABLE    (*(volatile unsigned int*)(NVIC_BASE + 0x010))
-#define VICINTENCLEAR   (*(volatile unsigned int*)(NVIC_BASE + 0x014))
-#define VICSOFTINT      (*(volatile unsigned int*)(NVIC_BASE + 0x018))
-
-// Enable IRQ globally (implemented in startup.S)
-extern void interrupt_enable(void);
-extern void interrupt_disable(void);
-
-/*-----------------------------------------------------------------
-  IRQ handler
------------------------------------------------------------------*/
-void irq_handler(void) {
-    if (VICIRQSTATUS & TIMER0_IRQ_BIT) {
-        // Clear timer0 interrupt in the timer peripheral
-        TIMER0_INTCLR = 1;
-        // Trigger a context switch
-        __asm__ volatile("svc 0");
-    }
+static void print(const char *s) {
+    uint32_t len = 0;
+    while (s[len]) len++;
+    uart_write_blocking(s, len);
 }
 
-/* SVC handler: calls scheduler_tick */
-void svc_handler(void) {
-    scheduler_tick();
-}
-
-/*-----------------------------------------------------------------
-  Tasks
------------------------------------------------------------------*/
-#define STACK_SIZE (4096 / 4)
-
-static uint32_t stack1[STACK_SIZE];
-static uint32_t stack2[STACK_SIZE];
-
 void task1(void) {
     while (1) {
-       uart_puts("TASK 1\r\n");
+       print("TASK 1\r\n");
        // sleep(1);
         __asm__ volatile("nop");
     }
@@ -64,48 +24,36 @@ void task1(void) {
 
 void task2(void) {
     while (1) {
-       uart_puts("TASK 222\r\n");
+       print("TASK 222\r\n");
        // sleep(5);
         __asm__ volatile("nop");
     }
 }
 
-void idle(void) {
-    while (1) {
-        __asm__ volatile("nop");
-    }
-}
-
-
 /*-----------------------------------------------------------------
   Main
 -----------------------------------------------------------------*/
 int main(void) {
+    uart_init();
     uart_puts("Booting...\r\n");
 
-    // Configure timer for 1ms periodic interrupts
-    TIMER0_CONTROL = 0x00;     // Stop timer
-    TIMER0_LOAD    = TIMER0_MS; 
-    TIMER0_INTCLR  = 0;        // Clear any pending interrupt
-    TIMER0_CONTROL = 0xE2;     // Enable: Timer, Periodic, IRQ
-
-    // Enable interrupt in VIC
-    VICINTENABLE = 0x10;
-
-    // Enable global IRQs
-    interrupt_enable();
+    // Timestamp timer, VIC lines
+    board_init();
 
     // Initialize scheduler
-    scheduler_init();
+    scheduler_init(NULL);
+
+#ifdef SCHED_SELFTEST
+    uart_puts(sched_selftest() ? "SELFTEST FAIL\r\n" : "SELFTEST PASS\r\n");
+#endif
 
     // Create tasks
-    //task_create(idle, idle_stack, STACK_SIZE, 10);
-    task_create(task1, stack1, STACK_SIZE, 0);
-    task_create(task2, stack2, STACK_SIZE, 0);
+    task_create(task1, NULL, STACK_SIZE, 0);
+    task_create(task2, NULL, STACK_SIZE, 0);
 
     uart_puts("Starting scheduler...\r\n");
 
-    // Start the scheduler (never returns)
+    // Start the scheduler (never returns, enables IRQs with the first task)
     scheduler_start();
 
     // Safety infinite loop (should never reach here)
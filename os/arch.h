@@ -0,0 +1,47 @@
+#ifndef ARCH_H
+#define ARCH_H
+
+#include <stdint.h>
+#include "critical.h"
+
+/**
+ * @file arch.h
+ * @brief CPU layer under the scheduler core.
+ *
+ * What os/scheduler.c needs from the CPU besides IRQ masking
+ * (critical.h): the exception-mode test, the SVC trap into svc_handler(),
+ * the jump into the first task and the wait for interrupt. On the ARM926
+ * these are inline instructions and startup.S. With SCHED_HOST the
+ * kernel core builds natively and test/sim.c provides them, together
+ * with the board hooks from scheduler.h and a simulated tick.
+ */
+
+#ifdef SCHED_HOST
+
+int arch_in_exception(void);
+void arch_syscall(void);
+void context_start(void);
+
+#else
+
+/* Running in an exception handler (tasks and main run in SYS mode)? */
+static inline int arch_in_exception(void) {
+    uint32_t cpsr;
+    __asm__ volatile("mrs %0, cpsr" : "=r"(cpsr));
+    return (cpsr & 0x1F) != 0x1F;
+}
+
+/* Trap into svc_handler(); the SVC exit path performs any switch */
+static inline void arch_syscall(void) {
+    __asm__ volatile("svc #0" ::: "memory");
+}
+
+/* Load svc_switch_to and return into it (startup.S, never returns) */
+void context_start(void) __attribute__((noreturn));
+
+#endif /* SCHED_HOST */
+
+/* Wait for interrupt (startup.S: CP15 c7, c0, 4) */
+void cpu_wait(void);
+
+#endif // ARCH_H
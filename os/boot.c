@@ -0,0 +1,34 @@
+#include "boot.h"
+#include "scheduler.h"
+#include "uart.h"
+
+static uint32_t boot_stamp[BOOT_PHASES];
+static uint8_t boot_seen;
+static uint8_t boot_reported;
+
+void boot_mark(boot_phase_t phase) {
+    if (phase >= BOOT_PHASES || (boot_seen & (1U << phase))) return;
+
+    boot_stamp[phase] = timestamp_us();
+    boot_seen |= 1U << phase;
+}
+
+void boot_report(void) {
+    static const char *const names[BOOT_PHASES] = {
+        [BOOT_MAIN] = "main", [BOOT_SCHED_START] = "sched_start",
+        [BOOT_FIRST_TASK] = "first_task",
+    };
+
+    if (boot_reported) return;
+    boot_reported = 1;
+
+    uart_puts("boot:");
+    for (uint32_t i = 0; i < BOOT_PHASES; i++) {
+        if (!(boot_seen & (1U << i))) continue;
+        uart_puts(" ");
+        uart_puts(names[i]);
+        uart_puts("=");
+        uart_putdec(boot_stamp[i]);
+    }
+    uart_puts(" us\r\n");
+}
@@ -0,0 +1,34 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+
+/**
+ * @file boot.h
+ * @brief Boot-phase timestamps, reported once when the first task starts.
+ *
+ * reset starts Timer1 before anything else, so timestamp_us() counts
+ * microseconds since reset. Each phase is stamped the first time it is
+ * reached; scheduler_start() prints the line
+ *   boot: main=<us> sched_start=<us> first_task=<us>
+ * just before dispatching the first task.
+ */
+
+typedef enum {
+    BOOT_MAIN = 0,          // C runtime done (.data copied, .bss zeroed), see startup.S
+    BOOT_SCHED_START,       // scheduler_start() entered
+    BOOT_FIRST_TASK,        // first task about to be dispatched
+    BOOT_PHASES
+} boot_phase_t;
+
+/**
+ * @brief Record timestamp_us() for a phase; later calls for it are ignored.
+ */
+void boot_mark(boot_phase_t phase);
+
+/**
+ * @brief Print the recorded phases (polled UART, once).
+ */
+void boot_report(void);
+
+#endif // BOOT_H
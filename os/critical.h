@@ -0,0 +1,45 @@
+#ifndef CRITICAL_H
+#define CRITICAL_H
+
+#include <stdint.h>
+
+/**
+ * @file critical.h
+ * @brief Nestable IRQ-masked critical sections.
+ *
+ * irq_save() masks IRQs and returns the previous CPSR control byte;
+ * irq_restore() puts it back, so a section entered with IRQs already
+ * masked (nested call, IRQ handler) leaves them masked. FIQs stay
+ * enabled. Keep sections short: their length adds to the IRQ latency.
+ *
+ * To keep other tasks out without masking anything, use sched_lock().
+ *
+ *     irq_flags_t flags = irq_save();
+ *     ...
+ *     irq_restore(flags);
+ *
+ * Host builds (SCHED_HOST, `make test`) get them from test/sim.c.
+ */
+
+typedef uint32_t irq_flags_t;
+
+#ifdef SCHED_HOST
+irq_flags_t irq_save(void);
+void irq_restore(irq_flags_t flags);
+#else
+
+static inline irq_flags_t irq_save(void) {
+    uint32_t cpsr, masked;
+    __asm__ volatile("mrs %0, cpsr\n\t"
+                     "orr %1, %0, #0x80\n\t"
+                     "msr cpsr_c, %1"
+                     : "=r"(cpsr), "=r"(masked) :: "memory");
+    return cpsr;
+}
+
+static inline void irq_restore(irq_flags_t flags) {
+    __asm__ volatile("msr cpsr_c, %0" :: "r"(flags) : "memory");
+}
+#endif /* SCHED_HOST */
+
+#endif // CRITICAL_H
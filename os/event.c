@@ -0,0 +1,79 @@
+#include "event.h"
+#include "kernel.h"
+#include "critical.h"
+
+static inline int event_match(uint32_t bits, uint32_t mask, uint32_t opts) {
+    return (opts & EVENT_WAIT_ALL) ? (bits & mask) == mask : (bits & mask) != 0;
+}
+
+void event_init(event_group_t *g) {
+    g->bits = 0;
+    g->waiters.head = NULL;
+}
+
+/* --- Set and wake (IRQs masked) --- */
+static uint32_t event_release(event_group_t *g, uint32_t bits) {
+    uint32_t clear = 0;
+    int woken = 0;
+
+    g->bits |= bits;
+
+    // Every waiter sees the same flags; EVENT_CLEAR applies after the scan
+    task_t *t = g->waiters.head;
+    while (t) {
+        task_t *next = t->next;
+        if (event_match(g->bits, t->wait_bits, t->wait_bits_opts)) {
+            if (t->wait_bits_opts & EVENT_CLEAR) clear |= t->wait_bits;
+            t->wait_bits = g->bits;
+            sched_wake(t);
+            woken = 1;
+        }
+        t = next;
+    }
+    g->bits &= ~clear;
+
+    if (woken) sched_preempt();
+    return g->bits;
+}
+
+uint32_t event_set(event_group_t *g, uint32_t bits) {
+    irq_flags_t flags = irq_save();
+    uint32_t now = event_release(g, bits);
+    irq_restore(flags);
+    return now;
+}
+
+uint32_t event_set_isr(event_group_t *g, uint32_t bits) {
+    return event_release(g, bits);
+}
+
+uint32_t event_clear(event_group_t *g, uint32_t bits) {
+    irq_flags_t flags = irq_save();
+    uint32_t old = g->bits;
+    g->bits = old & ~bits;
+    irq_restore(flags);
+    return old;
+}
+
+uint32_t event_get(const event_group_t *g) {
+    return g->bits;
+}
+
+uint32_t event_wait(event_group_t *g, uint32_t mask, uint32_t opts, uint32_t timeout) {
+    if (!mask) return 0;
+
+    irq_flags_t flags = irq_save();
+    uint32_t seen = g->bits;
+    if (event_match(seen, mask, opts)) {
+        if (opts & EVENT_CLEAR) g->bits = seen & ~mask;
+    } else {
+        task_t *t = sched_current();
+        t->wait_bits = mask;
+        t->wait_bits_opts = (uint8_t)opts;
+
+        // event_release() stores the satisfying flags in wait_bits
+        seen = sched_block_timeout(&g->waiters, timeout) == SCHED_WAIT_OK ? t->wait_bits : 0;
+    }
+    irq_restore(flags);
+    return seen;
+}
@@ -0,0 +1,76 @@
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <stdint.h>
+#include "scheduler.h"
+
+/**
+ * @file event.h
+ * @brief Event groups: wait for any or all of 32 flags.
+ *
+ * One task can wait on several sources at once (UART RX, a timer, a
+ * message, ...) when each source sets its own bit. Waiters block in the
+ * scheduler, optionally with a timeout on the wakeup queue, and are woken
+ * exactly once, by the event_set() that satisfies them. event_set_isr()
+ * may be called from interrupt handlers.
+ */
+
+typedef struct {
+    volatile uint32_t bits;
+    wait_queue_t waiters;
+} event_group_t;
+
+#define EVENT_GROUP_INIT { 0, WAIT_QUEUE_INIT }
+
+/* event_wait() options */
+#define EVENT_WAIT_ALL  (1U << 0)   // every bit of the mask, else any of them
+#define EVENT_CLEAR     (1U << 1)   // clear the awaited bits once satisfied
+
+/**
+ * @brief Initialise an event group with all flags clear.
+ */
+void event_init(event_group_t *g);
+
+/**
+ * @brief Set flags and wake every waiter they satisfy.
+ *
+ * Woken tasks that outrank the caller run before this returns. Task
+ * context only; use event_set_isr() from interrupt handlers.
+ *
+ * @return The flags after setting (and any EVENT_CLEAR by woken waiters).
+ */
+uint32_t event_set(event_group_t *g, uint32_t bits);
+
+/**
+ * @brief event_set() for IRQ context; a woken task that outranks the
+ * interrupted one runs on IRQ exit.
+ */
+uint32_t event_set_isr(event_group_t *g, uint32_t bits);
+
+/**
+ * @brief Clear flags (does not wake anyone).
+ *
+ * @return The flags before clearing.
+ */
+uint32_t event_clear(event_group_t *g, uint32_t bits);
+
+/**
+ * @brief Current flags.
+ */
+uint32_t event_get(const event_group_t *g);
+
+/**
+ * @brief Wait until any (or, with EVENT_WAIT_ALL, all) of @p mask is set.
+ *
+ * Returns at once if the condition already holds. With EVENT_CLEAR the
+ * awaited bits are cleared as the wait completes. Task context only.
+ *
+ * @param mask    Flags to wait for, 0 returns 0 immediately.
+ * @param opts    EVENT_WAIT_ALL and/or EVENT_CLEAR.
+ * @param timeout Ticks to wait, 0 waits forever.
+ * @return The group's flags when the wait was satisfied (before any
+ *         clearing), or 0 on timeout.
+ */
+uint32_t event_wait(event_group_t *g, uint32_t mask, uint32_t opts, uint32_t timeout);
+
+#endif // EVENT_H
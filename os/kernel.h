@@ -0,0 +1,165 @@
+#ifndef KERNEL_H
+#define KERNEL_H
+
+#include <stdint.h>
+#include "scheduler.h"
+#include "stats.h"
+
+/**
+ * @file kernel.h
+ * @brief Scheduler internals shared by kernel objects (sync, queues, ...).
+ *
+ * Not for application code. Unless noted otherwise, every function here
+ * must be called with IRQs masked.
+ */
+
+#ifndef NULL
+#define NULL ((void*)0)
+#endif
+
+#define MAX_PRIORITIES (32U)
+
+/* sched_block_timeout() results */
+#define SCHED_WAIT_OK       (0)
+#define SCHED_WAIT_TIMEOUT  (-1)
+
+struct mutex;
+
+/* --- Task states --- */
+typedef enum {
+    TASK_READY,
+    TASK_RUNNING,
+    TASK_SLEEPING,
+    TASK_BLOCKED,   // waiting on a wait_queue_t
+    TASK_STOPPED
+} task_state_t;
+
+/* task_t.flags */
+#define TASK_OWNS_STACK (1U << 0)   // stack came from stack_alloc()
+#define TASK_STACK_OVF  (1U << 1)   // canary hit or frame headroom used (reported once)
+
+/* --- Task Control Block --- */
+typedef struct task 
+{
+    uint32_t *sp;        // saved context frame, MUST stay at offset 0 (startup.S)
+    uint32_t *stack;
+    uint32_t stack_size;
+    void (*entry)(void);
+    uint8_t flags;
+
+    struct task *next; // for ready lists and wait queues
+    struct task *prev;
+
+    struct task *wake_next; // for the wakeup queue
+    struct task *wake_prev;
+
+    task_state_t state;
+    uint32_t wake_tick;  // absolute tick at which to wake
+    uint8_t priority;       // effective priority (may be boosted)
+    uint8_t base_priority;  // priority given at task_create
+    uint16_t quantum;       // time slice in ticks, 0 = run to block
+
+    wait_queue_t *wait_q;       // queue we are blocked on
+    int8_t wait_result;         // SCHED_WAIT_OK or SCHED_WAIT_TIMEOUT
+    struct mutex *wait_mutex;   // mutex we are blocked on (for inheritance)
+    uint32_t wait_bits;         // event_wait(): mask while blocked, then the bits seen
+    uint8_t wait_bits_opts;     // event_wait(): EVENT_WAIT_ALL / EVENT_CLEAR
+    struct mutex *held;         // mutexes we own
+
+    struct task *all_next;      // every live task, newest first
+
+    uint32_t period;            // periodic tasks: release interval in ticks, else 0
+    uint32_t rel_deadline;      // deadline relative to each release
+    uint32_t release;           // absolute tick of the current release
+    uint32_t abs_deadline;      // release + rel_deadline
+    uint32_t jobs;              // completed jobs
+    uint32_t deadline_misses;   // jobs that finished after abs_deadline
+    uint32_t skipped;           // releases dropped because a job overran
+#if SCHED_STATS
+    uint32_t run_time;          // us on the CPU, charged at switch-out
+    uint32_t run_count;         // times switched in
+#endif
+} task_t;
+
+/**
+ * @brief Get the running task (NULL before scheduler_start()).
+ */
+task_t *sched_current(void);
+
+/**
+ * @brief Head of the list of all tasks (linked through all_next).
+ *
+ * Includes tasks that exited but were not reaped yet (TASK_STOPPED).
+ */
+task_t *sched_task_list(void);
+
+/**
+ * @brief The kernel's idle task (NULL before scheduler_init()).
+ */
+task_t *sched_idle_task(void);
+
+/**
+ * @brief Current tick, exact even inside a stretched tickless period
+ * (which it ends, resuming 1-tick interrupts). IRQs masked.
+ */
+uint32_t sched_tick_sync(void);
+
+/**
+ * @brief Tick count as last accounted, without touching the timer (trace,
+ * observers). Lags inside a stretched tickless period.
+ */
+uint32_t sched_tick_raw(void);
+
+/**
+ * @brief Block the current task on a wait queue and switch away.
+ *
+ * Task context only. Returns, still with IRQs masked, once another
+ * context has called sched_wake() on the task.
+ */
+void sched_block(wait_queue_t *wq);
+
+/**
+ * @brief sched_block() that gives up after a number of ticks.
+ *
+ * The timeout runs on the scheduler's wakeup queue.
+ *
+ * @param ticks Timeout in ticks, 0 waits forever.
+ * @return SCHED_WAIT_OK if woken, SCHED_WAIT_TIMEOUT if the time ran out.
+ */
+int sched_block_timeout(wait_queue_t *wq, uint32_t ticks);
+
+/**
+ * @brief Make a blocked task ready again.
+ *
+ * Removes it from its wait queue and cancels any timeout. Does not switch; call sched_preempt()
+ * once all wakeups are done.
+ */
+void sched_wake(task_t *t);
+
+/**
+ * @brief Switch to a higher-priority ready task, if there is one.
+ *
+ * From task context the switch happens before this returns; from IRQ
+ * context it happens on IRQ exit.
+ */
+void sched_preempt(void);
+
+/**
+ * @brief Change a task's effective priority, keeping its ready list or
+ * wait queue position consistent. Does not switch.
+ */
+void sched_set_priority(task_t *t, uint8_t priority);
+
+/**
+ * @brief Recycle the TCBs and stacks of exited tasks.
+ *
+ * Task context, IRQs enabled (called by task_create/task_delete).
+ */
+void sched_reap(void);
+
+/**
+ * @brief Remove and return the highest-priority waiter (NULL if empty).
+ */
+task_t *wait_queue_pop(wait_queue_t *wq);
+
+#endif // KERNEL_H
@@ -0,0 +1,22 @@
+#include "klib.h"
+
+/* value / 10 for any 32-bit value: 0xCCCCCCCD = ceil(2^35 / 10) */
+static inline uint32_t div10(uint32_t value) {
+    return (uint32_t)(((uint64_t)value * 0xCCCCCCCDU) >> 35);
+}
+
+uint32_t klib_utoa(uint32_t value, char *buf) {
+    char tmp[KLIB_UTOA_MAX - 1];
+    uint32_t n = 0;
+
+    // Least significant digit first, then reversed into buf
+    do {
+        uint32_t q = div10(value);
+        tmp[n++] = (char)('0' + (value - q * 10));
+        value = q;
+    } while (value);
+
+    for (uint32_t i = 0; i < n; i++) buf[i] = tmp[n - 1 - i];
+    buf[n] = '\0';
+    return n;
+}
@@ -0,0 +1,35 @@
+#ifndef KLIB_H
+#define KLIB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file klib.h
+ * @brief Kernel string/memory primitives.
+ *
+ * memcpy/memset/memmove (os/klib.S) keep their standard names and
+ * semantics, so they also serve the calls GCC emits for struct copies and
+ * zeroing; word-aligned buffers move 32 bytes per ldm/stm burst.
+ */
+
+void *memcpy(void *dst, const void *src, size_t n);
+void *memmove(void *dst, const void *src, size_t n);
+void *memset(void *dst, int c, size_t n);
+
+/* Longest klib_utoa() output plus the terminating NUL ("4294967295") */
+#define KLIB_UTOA_MAX (11U)
+
+/**
+ * @brief Format an unsigned value as decimal, NUL-terminated.
+ *
+ * Divides by 10 through a reciprocal multiply (umull) instead of the
+ * __aeabi_uidiv software routine.
+ *
+ * @param value Value to format.
+ * @param buf   At least KLIB_UTOA_MAX bytes.
+ * @return Number of digits written (excluding the NUL).
+ */
+uint32_t klib_utoa(uint32_t value, char *buf);
+
+#endif // KLIB_H
@@ -0,0 +1,138 @@
+#include "mem.h"
+#include "critical.h"
+
+#ifndef NULL
+#define NULL ((void*)0)
+#endif
+
+/* Stack size classes: 256 B << 0 .. 6 */
+#define STACK_CLASS_MIN_SHIFT 8U
+#define STACK_CLASSES         7U
+
+/* Heap region (linker.ld) */
+extern uint8_t __heap_start[];
+extern uint8_t __heap_end[];
+
+static uintptr_t arena_next;
+static pool_t stack_pools[STACK_CLASSES];
+
+/* --- Arena --- */
+void *arena_alloc(uint32_t size, uint32_t align) {
+    void *p = NULL;
+
+    irq_flags_t flags = irq_save();
+    if (!arena_next) arena_next = (uintptr_t)__heap_start;
+
+    uintptr_t start = (arena_next + align - 1) & ~(uintptr_t)(align - 1);
+    if (start >= arena_next && size <= (uintptr_t)__heap_end - start) {
+        arena_next = start + size;
+        p = (void *)start;
+    }
+    irq_restore(flags);
+    return p;
+}
+
+uint32_t arena_free_bytes(void) {
+    uintptr_t next = arena_next ? arena_next : (uintptr_t)__heap_start;
+    return (uint32_t)((uintptr_t)__heap_end - next);
+}
+
+/* --- Pools --- */
+void pool_init(pool_t *p, uint32_t block_size) {
+    *p = (pool_t)POOL_INIT(block_size);
+}
+
+int pool_create(pool_t *p, uint32_t block_size, uint32_t count) {
+    pool_init(p, block_size);
+    p->grows = 0;
+
+    uint8_t *blocks = arena_alloc(p->block_size * count, 8);
+    if (!blocks) return -1;
+
+    p->carve = blocks;
+    p->carve_end = blocks + p->block_size * count;
+    p->total = count;
+    return 0;
+}
+
+/* Free list, else the next never-used block (IRQs masked) */
+static void *pool_get(pool_t *p) {
+    void *b = p->free;
+    if (b) {
+        p->free = *(void **)b;
+    } else if (p->carve != p->carve_end) {
+        b = p->carve;
+        p->carve += p->block_size;
+    }
+    return b;
+}
+
+/* Usage counters for an allocation attempt (IRQs masked) */
+static void *pool_take(pool_t *p, void *b) {
+    if (!b) {
+        p->fails++;
+        return NULL;
+    }
+    if (++p->used > p->peak) p->peak = p->used;
+    return b;
+}
+
+void *pool_alloc_isr(pool_t *p) {
+    return pool_take(p, pool_get(p));
+}
+
+void *pool_alloc(pool_t *p) {
+    irq_flags_t flags = irq_save();
+    void *b = pool_get(p);
+    if (!b && p->grows && (b = arena_alloc(p->block_size, 8))) p->total++;
+    b = pool_take(p, b);
+    irq_restore(flags);
+    return b;
+}
+
+void pool_free_isr(pool_t *p, void *block) {
+    if (!block) return;
+
+    *(void **)block = p->free;
+    p->free = block;
+    p->used--;
+}
+
+void pool_free(pool_t *p, void *block) {
+    irq_flags_t flags = irq_save();
+    pool_free_isr(p, block);
+    irq_restore(flags);
+}
+
+void pool_stats(const pool_t *p, pool_stats_t *out) {
+    irq_flags_t flags = irq_save();
+    out->block_size = p->block_size;
+    out->total = p->total;
+    out->used = p->used;
+    out->peak = p->peak;
+    out->fails = p->fails;
+    irq_restore(flags);
+}
+
+/* --- Task stacks --- */
+static uint32_t stack_class(uint32_t bytes) {
+    uint32_t c = 0;
+    while (c < STACK_CLASSES && (1U << (STACK_CLASS_MIN_SHIFT + c)) < bytes) c++;
+    return c;
+}
+
+uint32_t *stack_alloc(uint32_t *words) {
+    uint32_t c = stack_class(*words * sizeof(uint32_t));
+    if (c >= STACK_CLASSES) return NULL;
+
+    pool_t *p = &stack_pools[c];
+    if (!p->block_size) pool_init(p, 1U << (STACK_CLASS_MIN_SHIFT + c));
+
+    *words = p->block_size / sizeof(uint32_t);
+    return pool_alloc(p);
+}
+
+void stack_free(uint32_t *stack, uint32_t words) {
+    uint32_t c = stack_class(words * sizeof(uint32_t));
+    if (c < STACK_CLASSES) pool_free(&stack_pools[c], stack);
+}
@@ -0,0 +1,134 @@
+#ifndef MEM_H
+#define MEM_H
+
+#include <stdint.h>
+
+/**
+ * @file mem.h
+ * @brief Kernel memory: bump arena over the linker.ld heap region plus
+ * fixed-block pools carved from it.
+ *
+ * The arena never frees; anything that is recycled (TCBs, task stacks)
+ * goes through a pool whose free list keeps released blocks for reuse.
+ *
+ * Pools come in two kinds:
+ * - growing (POOL_INIT, pool_init): take blocks from the arena on demand;
+ * - sized (POOL_DEFINE, pool_create): a fixed number of blocks in static
+ *   storage or carved from the arena up front, never more.
+ * Allocation is O(1) either way: the free list, else the next never-used
+ * block. The _isr variants work with IRQs already masked (the ARM926 has
+ * no LDREX/STREX, so short masked sections are the lock); they never touch
+ * the arena, so from an ISR a growing pool only hands out freed blocks.
+ * Blocks can then travel by pointer through a queue_t from an ISR to a
+ * task and back (zero copy).
+ */
+
+/* --- Fixed-block pool --- */
+typedef struct {
+    void *free;            // singly linked free blocks
+    uint32_t block_size;   // bytes, multiple of 8
+    uint8_t *carve;        // sized pools: next never-used block
+    uint8_t *carve_end;
+    uint8_t grows;         // may take more blocks from the arena
+    uint32_t total;        // blocks owned (sized: all of them)
+    uint32_t used;         // blocks handed out
+    uint32_t peak;         // highest `used` so far
+    uint32_t fails;        // allocations that returned NULL
+} pool_t;
+
+/* Per-pool usage, see pool_stats() */
+typedef struct {
+    uint32_t block_size;
+    uint32_t total;
+    uint32_t used;
+    uint32_t peak;
+    uint32_t fails;
+} pool_stats_t;
+
+#define POOL_BLOCK_SIZE(size) (((size) + 7U) & ~7U)
+
+#define POOL_INIT(size) { .block_size = POOL_BLOCK_SIZE(size), .grows = 1 }
+
+/**
+ * @brief Define a sized pool of `count` blocks in static storage.
+ */
+#define POOL_DEFINE(name, size, count)                                      \
+    static uint64_t name##_blocks[(count) * POOL_BLOCK_SIZE(size) / 8U];    \
+    pool_t name = {                                                         \
+        .block_size = POOL_BLOCK_SIZE(size),                                \
+        .carve = (uint8_t *)name##_blocks,                                  \
+        .carve_end = (uint8_t *)name##_blocks + sizeof(name##_blocks),      \
+        .total = (count),                                                   \
+    }
+
+/**
+ * @brief Allocate from the arena (never freed).
+ *
+ * @param size  Bytes.
+ * @param align Power of two, at least 1.
+ * @return Pointer, or NULL if the heap is exhausted.
+ */
+void *arena_alloc(uint32_t size, uint32_t align);
+
+/**
+ * @brief Bytes still available in the arena.
+ */
+uint32_t arena_free_bytes(void);
+
+/**
+ * @brief Initialise an empty growing pool of blocks of the given size.
+ */
+void pool_init(pool_t *p, uint32_t block_size);
+
+/**
+ * @brief Initialise a sized pool with `count` blocks carved from the
+ * arena now. Task context only.
+ *
+ * @return 0 on success, -1 if the heap cannot hold them.
+ */
+int pool_create(pool_t *p, uint32_t block_size, uint32_t count);
+
+/**
+ * @brief Get a block: recycled from the free list, else a never-used
+ * one (from the pool's storage, or the arena for growing pools). Task
+ * context only; use pool_alloc_isr() from interrupt handlers.
+ *
+ * @return 8-byte aligned block, or NULL if the pool is exhausted.
+ */
+void *pool_alloc(pool_t *p);
+
+/**
+ * @brief Return a block obtained from pool_alloc() on the same pool.
+ */
+void pool_free(pool_t *p, void *block);
+
+/**
+ * @brief pool_alloc() / pool_free() with IRQs already masked (ISRs).
+ *
+ * Never grows the pool from the arena.
+ */
+void *pool_alloc_isr(pool_t *p);
+void pool_free_isr(pool_t *p, void *block);
+
+/**
+ * @brief Read a pool's usage counters (consistent snapshot).
+ */
+void pool_stats(const pool_t *p, pool_stats_t *out);
+
+/**
+ * @brief Allocate a task stack of at least `words` 32-bit words.
+ *
+ * Sizes are rounded up to a power-of-two class (256 B .. 16 KiB) so freed
+ * stacks can be reused by tasks of similar size.
+ *
+ * @param[in,out] words Requested size; set to the usable size on return.
+ * @return Stack base, or NULL if too large or out of memory.
+ */
+uint32_t *stack_alloc(uint32_t *words);
+
+/**
+ * @brief Free a stack from stack_alloc() (size as returned by it).
+ */
+void stack_free(uint32_t *stack, uint32_t words);
+
+#endif // MEM_H
@@ -0,0 +1,88 @@
+#include "mmu.h"
+
+/* --- First-level section descriptor bits (ARMv5) --- */
+#define SECT_TYPE    (2U << 0)
+#define SECT_B       (1U << 2)    // bufferable
+#define SECT_C       (1U << 3)    // cacheable
+#define SECT_SBO     (1U << 4)    // should be one on ARM926
+#define SECT_AP_RW   (3U << 10)   // read/write, all modes
+#define SECT_DOMAIN0 (0U << 5)
+
+#define SECT_NORMAL  (SECT_TYPE | SECT_SBO | SECT_AP_RW | SECT_DOMAIN0 | SECT_C | SECT_B)
+#define SECT_DEVICE  (SECT_TYPE | SECT_SBO | SECT_AP_RW | SECT_DOMAIN0)   // strongly ordered
+
+/* --- CP15 control register bits --- */
+#define CR_M (1U << 0)    // MMU
+#define CR_A (1U << 1)    // alignment faults
+#define CR_C (1U << 2)    // D-cache
+#define CR_W (1U << 3)    // write buffer
+#define CR_I (1U << 12)   // I-cache
+
+#define DACR_CLIENT0 (1U) // domain 0: check AP bits
+
+/* End of SDRAM as laid out by linker.ld */
+extern uint8_t __heap_end[];
+
+/* Own section: reset zeroes .bss with the MMU already on (see linker.ld) */
+static uint32_t mmu_table[4096] __attribute__((aligned(16384), section(".mmu_table")));
+
+void mmu_init(void) {
+    uint32_t ram_sections = ((uint32_t)__heap_end + 0xFFFFFU) >> 20;
+
+    for (uint32_t i = 0; i < 4096; i++)
+        mmu_table[i] = (i << 20) | (i < ram_sections ? SECT_NORMAL : SECT_DEVICE);
+
+    uint32_t zero = 0;
+    __asm__ volatile(
+        "mcr p15, 0, %0, c7, c7, 0\n"    // invalidate I+D caches
+        "mcr p15, 0, %0, c7, c10, 4\n"   // drain write buffer
+        "mcr p15, 0, %0, c8, c7, 0\n"    // invalidate TLBs
+        "mcr p15, 0, %1, c2, c0, 0\n"    // translation table base
+        "mcr p15, 0, %2, c3, c0, 0\n"    // domain access control
+        :
+        : "r"(zero), "r"(mmu_table), "r"(DACR_CLIENT0)
+        : "memory");
+
+    uint32_t cr;
+    __asm__ volatile("mrc p15, 0, %0, c1, c0, 0" : "=r"(cr));
+    cr &= ~CR_A;
+    cr |= CR_M | CR_C | CR_W | CR_I;
+    __asm__ volatile("mcr p15, 0, %0, c1, c0, 0" : : "r"(cr) : "memory");
+}
+
+/* --- Cache maintenance by MVA, one 32-byte line at a time --- */
+void dcache_clean_range(const void *addr, uint32_t len) {
+    uint32_t p = (uint32_t)addr & ~(CACHE_LINE_SIZE - 1);
+    uint32_t end = (uint32_t)addr + len;
+
+    for (; p < end; p += CACHE_LINE_SIZE)
+        __asm__ volatile("mcr p15, 0, %0, c7, c10, 1" : : "r"(p) : "memory");
+    __asm__ volatile("mcr p15, 0, %0, c7, c10, 4" : : "r"(0) : "memory");
+}
+
+void dcache_invalidate_range(void *addr, uint32_t len) {
+    uint32_t start = (uint32_t)addr;
+    uint32_t end = start + len;
+
+    // Lines shared with other data: write back before dropping
+    if (start & (CACHE_LINE_SIZE - 1))
+        dcache_flush_range((void *)start, 1);
+    if (end & (CACHE_LINE_SIZE - 1))
+        dcache_flush_range((void *)(end - 1), 1);
+
+    for (uint32_t p = start & ~(CACHE_LINE_SIZE - 1); p < end; p += CACHE_LINE_SIZE)
+        __asm__ volatile("mcr p15, 0, %0, c7, c6, 1" : : "r"(p) : "memory");
+}
+
+void dcache_flush_range(const void *addr, uint32_t len) {
+    uint32_t p = (uint32_t)addr & ~(CACHE_LINE_SIZE - 1);
+    uint32_t end = (uint32_t)addr + len;
+
+    for (; p < end; p += CACHE_LINE_SIZE)
+        __asm__ volatile("mcr p15, 0, %0, c7, c14, 1" : : "r"(p) : "memory");
+    __asm__ volatile("mcr p15, 0, %0, c7, c10, 4" : : "r"(0) : "memory");
+}
+
+void icache_invalidate(void) {
+    __asm__ volatile("mcr p15, 0, %0, c7, c5, 0" : : "r"(0) : "memory");
+}
@@ -0,0 +1,47 @@
+#ifndef MMU_H
+#define MMU_H
+
+#include <stdint.h>
+
+/**
+ * @file mmu.h
+ * @brief ARM926 MMU and cache setup, plus cache maintenance for buffers
+ * shared with bus masters (DMA-style).
+ *
+ * mmu_init() builds a flat (VA == PA) section-mapped table: SDRAM
+ * (vectors, code, data, stacks, heap) is write-back cacheable, everything
+ * else, including the 0x101xxxxx peripherals, is strongly ordered.
+ */
+
+#define CACHE_LINE_SIZE 32U
+
+/**
+ * @brief Build the translation table and enable MMU, I/D caches and the
+ * write buffer. Called once from reset in startup.S, before main().
+ */
+void mmu_init(void);
+
+/**
+ * @brief Write dirty lines in [addr, addr+len) back to memory
+ * (before a device reads the buffer).
+ */
+void dcache_clean_range(const void *addr, uint32_t len);
+
+/**
+ * @brief Discard cached lines in [addr, addr+len) (after a device wrote
+ * the buffer). Partial lines at either end are cleaned first so
+ * neighbouring data survives.
+ */
+void dcache_invalidate_range(void *addr, uint32_t len);
+
+/**
+ * @brief Clean and invalidate lines in [addr, addr+len).
+ */
+void dcache_flush_range(const void *addr, uint32_t len);
+
+/**
+ * @brief Invalidate the whole I-cache (after writing code).
+ */
+void icache_invalidate(void);
+
+#endif // MMU_H
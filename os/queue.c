@@ -0,0 +1,92 @@
+#include "queue.h"
+#include "kernel.h"
+#include "critical.h"
+
+/* ARM926 is in-order and single-core: only the compiler may reorder. */
+#define barrier() __asm__ volatile("" ::: "memory")
+
+void queue_init(queue_t *q, void *storage, uint32_t slot_size, uint32_t capacity) {
+    q->buf = storage;
+    q->slot_size = slot_size;
+    q->mask = capacity - 1;
+    q->head = 0;
+    q->tail = 0;
+    q->waiters.head = NULL;
+}
+
+/* --- Producer side --- */
+void *queue_reserve(queue_t *q) {
+    uint32_t head = q->head;
+    if (head - q->tail > q->mask) return NULL;   // full
+    return q->buf + (head & q->mask) * q->slot_size;
+}
+
+/* Publish the slot, return the blocked consumer (if any) */
+static task_t *queue_publish(queue_t *q) {
+    barrier();          // slot contents before the index
+    q->head++;
+    return q->waiters.head;
+}
+
+void queue_commit(queue_t *q) {
+    if (!queue_publish(q)) return;
+
+    // The consumer checks and blocks with IRQs masked, so seeing no
+    // waiter here means it will see the new head
+    irq_flags_t flags = irq_save();
+    task_t *t = q->waiters.head;
+    if (t) {
+        sched_wake(t);
+        sched_preempt();
+    }
+    irq_restore(flags);
+}
+
+void queue_commit_isr(queue_t *q) {
+    task_t *t = queue_publish(q);
+    if (t) {
+        sched_wake(t);
+        sched_preempt();
+    }
+}
+
+void queue_commit_fiq(queue_t *q) {
+    queue_publish(q);
+}
+
+void queue_notify_isr(queue_t *q) {
+    task_t *t = q->waiters.head;
+    if (t && q->tail != q->head) {
+        sched_wake(t);
+        sched_preempt();
+    }
+}
+
+/* --- Consumer side --- */
+void *queue_peek(queue_t *q) {
+    uint32_t tail = q->tail;
+    if (tail == q->head) return NULL;            // empty
+    barrier();          // index before the slot contents
+    return q->buf + (tail & q->mask) * q->slot_size;
+}
+
+void *queue_recv_wait(queue_t *q, uint32_t timeout) {
+    void *slot = queue_peek(q);
+    if (slot) return slot;
+
+    irq_flags_t flags = irq_save();
+    if (q->tail == q->head)
+        sched_block_timeout(&q->waiters, timeout);
+    irq_restore(flags);
+
+    return queue_peek(q);
+}
+
+void queue_release(queue_t *q) {
+    barrier();          // done with the slot before freeing it
+    q->tail++;
+}
+
+uint32_t queue_count(const queue_t *q) {
+    return q->head - q->tail;
+}
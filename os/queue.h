@@ -0,0 +1,116 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include <stdint.h>
+#include "scheduler.h"
+
+/**
+ * @file queue.h
+ * @brief Lock-free single-producer/single-consumer message queues.
+ *
+ * Fixed-capacity ring of fixed-size slots, used zero-copy: the producer
+ * reserves a slot, fills it in place and commits it; the consumer peeks
+ * at the oldest slot, uses it in place and releases it.
+ *
+ * Exactly one producer and one consumer at a time. The producer may be an
+ * ISR: reserve/commit never mask interrupts. A consumer task can block in
+ * the scheduler until data arrives.
+ */
+
+#define QUEUE_CACHE_LINE 32   // ARM926 cache line
+
+typedef struct {
+    /* Read-only after queue_init() */
+    uint8_t *buf;
+    uint32_t slot_size;
+    uint32_t mask;            // capacity - 1
+
+    /* Producer line */
+    volatile uint32_t head __attribute__((aligned(QUEUE_CACHE_LINE)));
+
+    /* Consumer line */
+    volatile uint32_t tail __attribute__((aligned(QUEUE_CACHE_LINE)));
+    wait_queue_t waiters;     // blocked consumer
+} __attribute__((aligned(QUEUE_CACHE_LINE))) queue_t;
+
+/**
+ * @brief Define a ready-to-use queue with static, cache-line-aligned
+ * storage (capacity must be a power of two).
+ */
+#define QUEUE_DEFINE(name, size, capacity)                               \
+    static uint8_t name##_storage[(size) * (capacity)]                   \
+        __attribute__((aligned(QUEUE_CACHE_LINE)));                      \
+    queue_t name = {                                                     \
+        .buf = name##_storage,                                           \
+        .slot_size = (size),                                             \
+        .mask = (capacity) - 1,                                          \
+    }
+
+/**
+ * @brief Initialise a queue over caller-provided storage.
+ *
+ * @param storage   slot_size * capacity bytes.
+ * @param slot_size Bytes per slot (keep a multiple of 4 for word access).
+ * @param capacity  Number of slots, must be a power of two.
+ */
+void queue_init(queue_t *q, void *storage, uint32_t slot_size, uint32_t capacity);
+
+/**
+ * @brief Producer: get the next free slot to fill in place.
+ *
+ * @return Slot pointer, or NULL if the queue is full.
+ */
+void *queue_reserve(queue_t *q);
+
+/**
+ * @brief Producer (task): publish the reserved slot, waking the consumer.
+ */
+void queue_commit(queue_t *q);
+
+/**
+ * @brief Producer (IRQ): queue_commit() for interrupt handlers. A woken
+ * consumer that outranks the interrupted task runs on IRQ exit.
+ */
+void queue_commit_isr(queue_t *q);
+
+/**
+ * @brief Producer (FIQ): publish the reserved slot without waking anyone.
+ *
+ * FIQ handlers must not touch the scheduler. Follow with fiq_signal() and
+ * call queue_notify_isr() from the signal handler to wake the consumer.
+ */
+void queue_commit_fiq(queue_t *q);
+
+/**
+ * @brief Wake a consumer blocked on a non-empty queue (IRQ context).
+ */
+void queue_notify_isr(queue_t *q);
+
+/**
+ * @brief Consumer: get the oldest committed slot without removing it.
+ *
+ * @return Slot pointer, or NULL if the queue is empty.
+ */
+void *queue_peek(queue_t *q);
+
+/**
+ * @brief Consumer: like queue_peek(), but block until a slot arrives.
+ *
+ * Task context only.
+ *
+ * @param timeout Ticks to wait, 0 waits forever.
+ * @return Slot pointer, or NULL on timeout.
+ */
+void *queue_recv_wait(queue_t *q, uint32_t timeout);
+
+/**
+ * @brief Consumer: hand the slot from queue_peek() back to the producer.
+ */
+void queue_release(queue_t *q);
+
+/**
+ * @brief Number of committed slots (a snapshot).
+ */
+uint32_t queue_count(const queue_t *q);
+
+#endif // QUEUE_H
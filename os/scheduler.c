@@ -1,36 +1,36 @@
-#include "scheduler.h"
+#include "kernel.h"
 #include <stdint.h>
-#include "uart.h"
-
-#define NULL ((void*)0)
-#define MAX_PRIORITIES (32U)
-#define MAX_TASKS      (16U)
-
-/* --- Task states --- */
-typedef enum {
-    TASK_READY,
-    TASK_RUNNING,
-    TASK_SLEEPING,
-    TASK_STOPPED
-} task_state_t;
-
-/* --- Task Control Block --- */
-typedef struct task 
-{
-    uint32_t *stack;
-    uint32_t stack_size;
-    uint32_t *sp;
-    uint32_t regs[13];
-    uint32_t lr;
-    uint32_t cpsr;       // saved CPSR of task
-
-    struct task *next; // for ready/sleep lists
-    struct task *prev;
-
-    task_state_t state;
-    uint32_t wake_tick;
-    uint8_t priority;
-} task_t;
+#include "trace.h"
+#include "mem.h"
+#include "sync.h"
+#include "boot.h"
+#include "klib.h"
+#include "swtimer.h"
+#include "arch.h"
+
+/* Stack size used when task_create() is given size 0 */
+#define TASK_DEFAULT_STACK_WORDS (256U)
+
+/* Idle task: stack, and a priority below any ready list (never queued) */
+#define IDLE_STACK_WORDS (256U)
+#define IDLE_PRIORITY    (MAX_PRIORITIES)
+
+/* Longest tickless stretch; must fit the board timer's reload range. */
+#define TICKLESS_MAX_TICKS (1000U)
+
+/*
+ * --- Saved context frame ---
+ * startup.S pushes the whole task context onto the task's own stack and
+ * stores only the frame address in task_t.sp. Layout, ascending:
+ *   cpsr, r0-r12, sp, lr, pc
+ */
+#define FRAME_CPSR   0
+#define FRAME_SP     14
+#define FRAME_LR     15
+#define FRAME_PC     16
+#define FRAME_WORDS  17
+
+#define TASK_INITIAL_CPSR (0x1FU) // SYS mode, ARM state, IRQ/FIQ enabled
 
 /* --- Scheduler state --- */
 typedef struct {
@@ -38,243 +38,754 @@ typedef struct {
     task_t *ready_tail[MAX_PRIORITIES];
     uint32_t ready_bitmap;
 
-    task_t *sleep_head;
+    task_t *sleep_head;   // wakeup queue, sorted by wake_tick
+    task_t *sleep_tail;   // latest wakeup: equal periods append here
+    uint32_t tick;        // absolute tick count
+    uint32_t tick_period; // ticks covered by the programmed timer period
+    uint32_t tick_hz;
+    uint32_t tick_us;     // microseconds per tick
+    uint32_t slice_start; // tick at which current's time slice began
+    uint16_t quantum[MAX_PRIORITIES]; // default slice per priority
+    uint32_t edf_levels;  // bit p: ready_head[p] is ordered by deadline
 
-    task_t task_pool[MAX_TASKS];
+    pool_t tcb_pool;      // TCBs, recycled through TASK_STOPPED
     uint32_t task_count;
 
     task_t *current;
+    volatile uint32_t lock_depth;   // sched_lock() nesting
+    volatile uint8_t lock_pending;  // a switch was held back by the lock
+    task_t *idle;         // runs when no ready list has a task
+    void (*idle_hooks[SCHED_IDLE_HOOKS])(void);
+    task_t *zombies;      // exited tasks whose stack is still being left
+    task_t *tasks;        // all TCBs, through task_t.all_next
+    task_t *check_next;   // idle's next canary check, NULL = list start
 } scheduler_t;
 
 
-/* Globals used only by the SVC assembly wrapper to perform the switch */
-volatile task_t *svc_switch_from = NULL; /* set by scheduler_tick() */
-volatile task_t *svc_switch_to   = NULL; /* set by scheduler_tick() */
+/*
+ * Globals used by the IRQ/SVC exit path in startup.S to perform the switch:
+ * svc_switch_from is the task whose context is live on the CPU (updated by
+ * the assembly), svc_switch_to the task that should run (set by
+ * scheduler_tick()). When they are equal the exit path skips the switch.
+ */
+volatile task_t *svc_switch_from = NULL;
+volatile task_t *svc_switch_to   = NULL;
 
 static scheduler_t sched;
 
+/* --- Forward declarations --- */
+static void ready_enqueue(task_t *t);
+static void ready_dequeue(task_t *t);
+static task_t *pick_next_task(void);
+static inline uint32_t ready_best(void);
+static inline int ready_outranks(task_t *curr, int rotate);
+static void sleep_enqueue(task_t *t);
+static void task_free(task_t *t);
+static task_t *task_new(void (*func)(void), void (*pc)(void), uint32_t *stack, uint32_t size,
+                        uint8_t priority);
+static void task_start(task_t *t);
+static void periodic_entry(void);
+static void idle_task(void);
+static void stack_check(task_t *t);
+static void sleep_locked(uint32_t wake_tick);
+static void sleep_dequeue(task_t *t);
+static void tick_resume_periodic(void);
+static void schedule(int rotate);
+static void reschedule(void);
+static void wait_queue_insert(wait_queue_t *wq, task_t *t);
+static void wait_queue_remove(wait_queue_t *wq, task_t *t);
+
+/* --- API --- */
+void scheduler_init(const sched_config_t *cfg) {
+    memset(&sched, 0, sizeof(sched));
+    sched.tick_period = 1;
+    pool_init(&sched.tcb_pool, sizeof(task_t));
 
-static void uart_puthex(unsigned int value) {
-    static const char hexchars[] = "0123456789ABCDEF";
-    char buf[11]; // "0x" + 8 digits + null
-    buf[0] = '0';
-    buf[1] = 'x';
-    for (int i = 0; i < 8; i++) {
-        buf[9 - i] = hexchars[value & 0xF];
-        value >>= 4;
+    sched.tick_hz = cfg && cfg->tick_hz ? cfg->tick_hz : SCHED_TICK_HZ_DEFAULT;
+    sched.tick_us = 1000000U / sched.tick_hz;
+    for (uint32_t p = 0; p < MAX_PRIORITIES; p++)
+        sched.quantum[p] = cfg ? cfg->quantum[p] : 1;
+    sched.edf_levels = cfg ? cfg->edf_levels : 0;
+
+    tick_timer_init(sched.tick_hz);
+
+    // The idle task is never queued: schedule() falls back to it
+    task_t *idle = task_new(idle_task, idle_task, NULL, IDLE_STACK_WORDS, 0);
+    if (idle) {
+        idle->priority = idle->base_priority = IDLE_PRIORITY;
+        idle->quantum = 0;
+        idle->all_next = sched.tasks;
+        sched.tasks = idle;
+        sched.idle = idle;
     }
-    buf[10] = '\0';
-    uart_puts(buf);
 }
 
-static void uart_putdec(unsigned int value) {
-    char buf[11];
-    int i = 10;
-    buf[i] = '\0';
-    if (value == 0) {
-        buf[--i] = '0';
-    } else {
-        while (value > 0 && i > 0) {
-            buf[--i] = '0' + (value % 10);
-            value /= 10;
+int scheduler_idle_hook(void (*hook)(void)) {
+    for (uint32_t i = 0; i < SCHED_IDLE_HOOKS; i++) {
+        if (!sched.idle_hooks[i]) {
+            sched.idle_hooks[i] = hook;
+            return 0;
         }
     }
-    uart_puts(&buf[i]);
+    return -1;
 }
 
+uint32_t scheduler_ms_to_ticks(uint32_t ms) {
+    if (sched.tick_hz == 1000) return ms;
+    return (uint32_t)(((uint64_t)ms * sched.tick_hz + 999) / 1000);
+}
 
-/* --- Forward declarations --- */
-static void ready_enqueue(task_t *t);
-static void ready_dequeue(task_t *t);
-static task_t *pick_next_task(void);
-static void sleep_enqueue(task_t *t);
+/* --- Task creation --- */
+struct task *task_create(void (*func)(void), uint32_t *stack, uint32_t size, uint8_t priority) {
+    task_t *t = task_new(func, func, stack, size, priority);
+    if (!t) return NULL;
 
-/* --- Minimal memset --- */
-static void memset(void *dst, int val, uint32_t n) {
-    uint8_t *p = dst;
-    while (n--) *p++ = (uint8_t)val;
+    task_start(t);
+    sched_preempt();    // created from a task: a better priority takes over
+    return t;
 }
 
-/* --- API --- */
-void scheduler_init(void) {
-    memset(&sched, 0, sizeof(sched));
+struct task *task_create_periodic(void (*job)(void), uint32_t *stack, uint32_t size,
+                                  uint8_t priority, uint32_t period, uint32_t deadline) {
+    if (!period) return NULL;
+
+    task_t *t = task_new(job, periodic_entry, stack, size, priority);
+    if (!t) return NULL;
+
+    t->period = period;
+    t->rel_deadline = deadline && deadline < period ? deadline : period;
+    task_start(t);  // first release now
+    sched_preempt();
+    return t;
 }
 
-/* --- Task creation --- */
-void task_create(void (*func)(void), uint32_t *stack, uint32_t size, uint8_t priority) {
-    if (sched.task_count >= MAX_TASKS) return;
+/* --- Allocate a TCB and stack, build the initial frame (not yet queued) --- */
+static task_t *task_new(void (*func)(void), void (*pc)(void), uint32_t *stack, uint32_t size,
+                        uint8_t priority) {
+    uint8_t task_flags = 0;
+
+    sched_reap();
+
+    if (!stack) {
+        if (!size) size = TASK_DEFAULT_STACK_WORDS;
+        stack = stack_alloc(&size);
+        task_flags |= TASK_OWNS_STACK;
+    }
+
+    task_t *t = stack ? pool_alloc(&sched.tcb_pool) : NULL;
+    if (!t) {
+        if (stack && (task_flags & TASK_OWNS_STACK)) stack_free(stack, size);
+        irq_flags_t flags = irq_save();
+        TRACE_ERR(TRACE_EV_TASK_NOMEM, func, 0);
+        irq_restore(flags);
+        return NULL;
+    }
 
-    task_t *t = &sched.task_pool[sched.task_count++];
+    memset(t, 0, sizeof(*t));
     t->stack = stack;
     t->stack_size = size;
+    t->flags = task_flags;
 
-    // Start SP at top of stack (stack grows down)
-    t->sp = &stack[size - 1];
+    t->entry = func;
 
-    // Zero registers in TCB (r4-r11 stored separately in regs[])
-    memset(t->regs, 0, sizeof(t->regs));
+    // Build an initial frame at the (8-byte aligned) top of the stack,
+    // as if the task had been interrupted right at its entry point
+    uint32_t *top = (uint32_t *)((uintptr_t)&stack[size] & ~(uintptr_t)7);
+    uint32_t *frame = top - FRAME_WORDS;
+#if SCHED_STACK_CHECK
+    for (uint32_t *p = stack; p < frame; p++) *p = STACK_PAINT;
+    stack[0] = STACK_CANARY;
+#endif
+    memset(frame, 0, FRAME_WORDS * sizeof(uint32_t));
+    frame[FRAME_CPSR] = TASK_INITIAL_CPSR;
+    frame[FRAME_SP]   = (uint32_t)(uintptr_t)top;
+    frame[FRAME_LR]   = (uint32_t)(uintptr_t)task_exit;  // returning from func exits
+    frame[FRAME_PC]   = (uint32_t)(uintptr_t)pc;
+    t->sp = frame;
 
-    t->lr = (uint32_t)func;    // fallback
-    t->cpsr = 0x1F;            // SYS mode
     t->priority = priority & 31;
+    t->base_priority = t->priority;
+    t->quantum = sched.quantum[t->priority];
     t->state = TASK_READY;
-    t->wake_tick = 0;
-    t->next = t->prev = NULL;
+    return t;
+}
+
+/*
+ * --- Canary check, reported once per task (IRQs masked) ---
+ * The outgoing task's frame is saved below its sp after this check, so a
+ * stack used to within FRAME_WORDS of the canary counts as overflowed:
+ * that save (now or at any deeper preemption) lands on the canary.
+ */
+static void stack_check(task_t *t) {
+#if SCHED_STACK_CHECK
+    int hit = t->stack[0] != STACK_CANARY || t->stack[FRAME_WORDS] != STACK_PAINT;
+    if (hit && !(t->flags & TASK_STACK_OVF)) {
+        t->flags |= TASK_STACK_OVF;
+        TRACE_ERR(TRACE_EV_STACK_OVF, t, t->stack[0]);
+    }
+#else
+    (void)t;
+#endif
+}
+
+/* --- Stack watermark: painted words above the canary never touched --- */
+uint32_t task_stack_high_water(struct task *t) {
+#if SCHED_STACK_CHECK
+    if (t->stack[0] != STACK_CANARY) return t->stack_size;
+
+    uint32_t i = 1;
+    while (i < t->stack_size && t->stack[i] == STACK_PAINT) i++;
+    return t->stack_size - i;
+#else
+    (void)t;
+    return 0;
+#endif
+}
+
+/*
+ * --- Idle task ---
+ * Background work, then sleep until the next interrupt. Every IRQ that
+ * leaves nothing else ready comes back here for another round.
+ */
+static void idle_task(void) {
+    for (;;) {
+        sched_reap();   // recycle exited tasks' TCBs and stacks
+
+#if SCHED_STACK_CHECK
+        // Catch overflows of tasks that rarely switch out, a few per pass
+        // so the walk stays short; task_free() moves the cursor off a TCB
+        for (uint32_t n = 0; n < SCHED_IDLE_STACK_CHECKS; n++) {
+            irq_flags_t flags = irq_save();
+            task_t *t = sched.check_next ? sched.check_next : sched.tasks;
+            if (t->state != TASK_STOPPED) stack_check(t);
+            sched.check_next = t->all_next;
+            irq_restore(flags);
+        }
+#endif
+
+        for (uint32_t i = 0; i < SCHED_IDLE_HOOKS; i++)
+            if (sched.idle_hooks[i]) sched.idle_hooks[i]();
+
+        cpu_wait();
+    }
+}
+
+task_t *sched_idle_task(void) {
+    return sched.idle;
+}
+
+/* --- Make a new task visible to the scheduler --- */
+static void task_start(task_t *t) {
+    irq_flags_t flags = irq_save();
+    tick_resume_periodic();
+    sched.task_count++;
+    t->all_next = sched.tasks;
+    sched.tasks = t;
+
+    if (t->period) {
+        t->release = sched.tick;
+        t->abs_deadline = t->release + t->rel_deadline;
+    }
 
     ready_enqueue(t);
+    TRACE_DBG(TRACE_EV_TASK_CREATE, t, t->entry);
+    irq_restore(flags);
+}
 
-    uart_puts("TASK ADDED: ");
-    uart_puthex((uint32_t)t);
-    uart_puts("\r\n");
+/*
+ * --- Periodic tasks ---
+ * The job runs once per release; releases stay on the grid
+ * first_release + n * period however long a job takes, so the rate does
+ * not drift. Releases that passed while a job was still running are
+ * skipped (and counted) rather than run back to back.
+ */
+static void periodic_job_done(task_t *t) {
+    irq_flags_t flags = irq_save();
+    tick_resume_periodic();
+    t->jobs++;
+    if ((int32_t)(sched.tick - t->abs_deadline) > 0) t->deadline_misses++;
+
+    uint32_t next = t->release + t->period;
+    while ((int32_t)(next - sched.tick) < 0) {
+        next += t->period;
+        t->skipped++;
+    }
+    t->release = next;
+    t->abs_deadline = next + t->rel_deadline;
+
+    sleep_locked(next);
+    sched_preempt();    // released at once: the new deadline may rank lower
+    irq_restore(flags);
+}
+
+static void periodic_entry(void) {
+    task_t *t = sched.current;
+
+    for (;;) {
+        t->entry();
+        periodic_job_done(t);
+    }
+}
+
+int task_period_stats(struct task *t, task_period_stats_t *out) {
+    if (!t || !t->period) return -1;
+
+    irq_flags_t flags = irq_save();
+    out->jobs = t->jobs;
+    out->deadline_misses = t->deadline_misses;
+    out->skipped = t->skipped;
+    irq_restore(flags);
+    return 0;
+}
+
+/* --- Task deletion: unlink, mark STOPPED, recycle TCB and stack --- */
+int task_delete(struct task *t) {
+    if (t && t == sched.idle) return -1;
+    if (t && t == sched.current) task_exit();
+
+    sched_reap();
+
+    irq_flags_t flags = irq_save();
+    if (!t || t->state == TASK_STOPPED) {
+        irq_restore(flags);
+        return -1;
+    }
+
+    if (t->state == TASK_READY) ready_dequeue(t);
+    if (t->wait_q) wait_queue_remove(t->wait_q, t);
+    sleep_dequeue(t);
+
+    // No boost from a waiter that is gone, no owner that is freed
+    mutex_cancel_wait(t);
+    mutex_release_all(t);
+
+    t->state = TASK_STOPPED;
+    sched.task_count--;
+    irq_restore(flags);
+
+    task_free(t);
+
+    // A released mutex may have woken a better task
+    sched_preempt();
+    return 0;
+}
+
+/* --- Task exit: also the initial LR of every task --- */
+void task_exit(void) {
+    task_t *t = sched.current;
+
+    irq_save();     // for good: the task never runs again
+
+    // Hand held mutexes to their waiters
+    mutex_release_all(t);
+    t->state = TASK_STOPPED;
+    sched.task_count--;
+
+    // The stack is in use until the switch away; park the task for
+    // sched_reap() to recycle from another task's context
+    t->next = sched.zombies;
+    sched.zombies = t;
+
+    TRACE_DBG(TRACE_EV_TASK_EXIT, t, 0);
+    yield();
+
+    for (;;) cpu_wait();    // never scheduled again
+}
+
+void sched_reap(void) {
+    irq_flags_t flags = irq_save();
+    task_t *t = sched.zombies;
+    sched.zombies = NULL;
+    irq_restore(flags);
+
+    while (t) {
+        task_t *next = t->next;
+        task_free(t);
+        t = next;
+    }
+}
+
+void task_set_quantum(struct task *t, uint32_t ticks) {
+    t->quantum = ticks > 0xFFFF ? 0xFFFF : (uint16_t)ticks;
+}
+
+static void task_free(task_t *t) {
+    irq_flags_t flags = irq_save();
+    task_t **link = &sched.tasks;
+    while (*link != t) link = &(*link)->all_next;
+    *link = t->all_next;
+    if (sched.check_next == t) sched.check_next = t->all_next;
+    irq_restore(flags);
+
+    if (t->flags & TASK_OWNS_STACK) stack_free(t->stack, t->stack_size);
+    pool_free(&sched.tcb_pool, t);
+}
+
+task_t *sched_task_list(void) {
+    return sched.tasks;
+}
+
+uint32_t scheduler_ticks(void) {
+    irq_flags_t flags = irq_save();
+    uint32_t now;
+    if (arch_in_exception()) {
+        // Read-only here: count the ticks gone in a stretched period
+        now = sched.tick + tick_timer_elapsed_us() / sched.tick_us;
+    } else {
+        tick_resume_periodic();
+        now = sched.tick;
+    }
+    irq_restore(flags);
+    return now;
+}
+
+uint32_t sched_tick_raw(void) {
+    return sched.tick;
 }
 
 /* --- Sleep --- */
 void sleep(uint32_t ms) {
     if (!sched.current) return;
 
+    irq_flags_t flags = irq_save();
+    tick_resume_periodic(); // sched.tick is stale while the timer is stretched
+    uint32_t ticks = scheduler_ms_to_ticks(ms);
+    sleep_locked(sched.tick + (ticks ? ticks : 1));
+    irq_restore(flags);
+}
+
+void sleep_until(uint32_t tick) {
+    if (!sched.current) return;
+
+    irq_flags_t flags = irq_save();
+    tick_resume_periodic();
+    sleep_locked(tick);
+    irq_restore(flags);
+}
+
+void sleep_us(uint32_t us) {
+    uint32_t deadline = timestamp_us() + us;
+
+    // Block until the last tick boundary before the deadline: boundary k
+    // comes k * tick_us - (time into this tick) from now...
+    if (sched.current && sched.tick_us) {
+        irq_flags_t flags = irq_save();
+        tick_resume_periodic();
+        uint32_t ticks = (us + tick_timer_elapsed_us()) / sched.tick_us;
+        if (ticks) sleep_locked(sched.tick + ticks);
+        irq_restore(flags);
+    }
+
+    // ...and spin on the microsecond timestamp for the rest
+    while ((int32_t)(deadline - timestamp_us()) > 0);
+}
+
+/*
+ * Sleep until an absolute tick, returning at once if it is not in the
+ * future. IRQs masked, sched.tick up to date; resumes still masked.
+ */
+static void sleep_locked(uint32_t wake_tick) {
     task_t *t = sched.current;
-    t->wake_tick = ms;
-    t->state = TASK_SLEEPING;
 
-    // Remove from ready queue immediately
-    ready_dequeue(t);
+    if ((int32_t)(wake_tick - sched.tick) <= 0) return;
 
-    // Add to sleep list
+    t->wake_tick = wake_tick;
+    t->state = TASK_SLEEPING;
+
+    // The running task is never on a ready list, just queue the wakeup
     sleep_enqueue(t);
 
-    // Do NOT trigger SVC; preemption only occurs on tick
+    // Switch away now; we resume here (IRQs still masked) once woken
+    yield();
+}
+
+/* --- Yield --- */
+void yield(void) {
+    arch_syscall();
+}
+
+/* --- Preemption lock: a counter only, IRQs stay enabled --- */
+void sched_lock(void) {
+    sched.lock_depth++;     // IRQ handlers only read it
+}
+
+void sched_unlock(void) {
+    if (--sched.lock_depth || !sched.lock_pending) return;
+
+    // An IRQ after the decrement switches by itself; yielding again is harmless
+    sched.lock_pending = 0;
+    yield();
+}
+
+/* --- SVC handler: voluntary reschedule from yield() --- */
+void svc_handler(void) {
+    if (!sched.current) return;
+
+    reschedule();
+}
+
+/* --- Blocking / wakeup for kernel objects (IRQs masked) --- */
+uint32_t sched_tick_sync(void) {
+    tick_resume_periodic();
+    return sched.tick;
+}
+
+task_t *sched_current(void) {
+    return sched.current;
+}
+
+void sched_block(wait_queue_t *wq) {
+    sched_block_timeout(wq, 0);
+}
+
+int sched_block_timeout(wait_queue_t *wq, uint32_t ticks) {
+    task_t *t = sched.current;
+
+    t->state = TASK_BLOCKED;
+    t->wait_q = wq;
+    t->wait_result = SCHED_WAIT_OK;
+    wait_queue_insert(wq, t);
+
+    if (ticks) {
+        tick_resume_periodic(); // sched.tick is stale while stretched
+        t->wake_tick = sched.tick + ticks;
+        sleep_enqueue(t);
+    }
+
+    yield();
+    return t->wait_result;
+}
+
+void sched_wake(task_t *t) {
+    if (t->wait_q) wait_queue_remove(t->wait_q, t);
+    sleep_dequeue(t);
+
+    t->state = TASK_READY;
+    ready_enqueue(t);
+
+    // A stretched period has no tick for round-robin with the new task
+    tick_resume_periodic();
+    TRACE_DBG(TRACE_EV_WAKE, t, 0);
+}
+
+void sched_preempt(void) {
+    task_t *curr = sched.current;
+    if (!curr || !sched.ready_bitmap) return;
+
+    // Equal priority waits for its turn in the round-robin
+    if (curr->state == TASK_RUNNING && !ready_outranks(curr, 0)) return;
+
+    if (arch_in_exception()) reschedule();   // switched on IRQ exit
+    else yield();
+}
+
+void sched_set_priority(task_t *t, uint8_t priority) {
+    priority &= 31;
+    if (t->priority == priority) return;
+
+    if (t->state == TASK_READY) {
+        ready_dequeue(t);
+        t->priority = priority;
+        ready_enqueue(t);
+    } else if (t->state == TASK_BLOCKED && t->wait_q) {
+        wait_queue_t *wq = t->wait_q;
+        wait_queue_remove(wq, t);
+        t->priority = priority;
+        wait_queue_insert(wq, t);
+    } else {
+        t->priority = priority;
+    }
+}
+
+/*
+ * --- Reschedule outside the tick ---
+ * Mid-period: bring sched.tick up to date first, schedule() computes
+ * the next timer period relative to it.
+ */
+static void reschedule(void) {
+    tick_resume_periodic();
+    schedule(1);
 }
 
 /* --- Start scheduler --- */
 void scheduler_start(void) {
+    boot_mark(BOOT_SCHED_START);
+    irq_flags_t flags = irq_save();
+
     task_t *first = pick_next_task();
-    if (!first) return;
+    if (!first) first = sched.idle;
+    if (!first) {
+        irq_restore(flags);
+        return;
+    }
 
     sched.current = first;
     first->state = TASK_RUNNING;
+    sched.slice_start = sched.tick;
+
+    TRACE_DBG(TRACE_EV_START, first, first->entry);
+    STATS_SWITCH(NULL, first);
 
-    uart_puts("START DATA:\r\n");
-    uart_puts("CURR SP:   ");
-    uart_puthex((uint32_t)first->sp);
-    uart_puts("\r\n");
-    uart_puts("CURR LR:   ");
-    uart_puthex((uint32_t)first->lr);
-    uart_puts("\r\n");
+    boot_mark(BOOT_FIRST_TASK);
+    boot_report();
 
-    __asm__ volatile(
-        "msr cpsr_c, #0x1F\n"     // SYS mode
-        "mov sp, %0\n"      // set stack pointer to task's SP
-        "mov lr, %1\n"      // load LR from TCB
-        "bx lr\n"           // branch to LR (resumes task)
-        :
-        : "r"(first->sp), "r"(first->lr)
-    );
+    // IRQs come back on with the first task's CPSR
+    svc_switch_to = first;
+    context_start();
 }
 
 
-/* --- Scheduler tick: called from SVC --- */
-/* --- Scheduler tick: called from SVC --- */
+/* --- Scheduler tick: called from the Timer0 IRQ --- */
 void scheduler_tick(void) {
-    uart_puts("\r\n[Scheduler Tick]\r\n");
+    /* Account for the whole period that just expired */
+    sched.tick += sched.tick_period;
+    TRACE_DBG(TRACE_EV_TICK, sched.tick, 0);
 
-    /* --- Wake sleeping tasks --- */
-    task_t *t = sched.sleep_head;
-    while (t) {
-        task_t *next = t->next;
-        if (t->wake_tick > 0) {
-            t->wake_tick--;
-            uart_puts(" Decrementing wake_tick for task ");
-            uart_puthex((uint32_t)t);
-            uart_puts(" -> ");
-            uart_putdec(t->wake_tick);
-            uart_puts("\r\n");
-        }
-        if (t->wake_tick == 0) {
-            uart_puts(" Waking task ");
-            uart_puthex((uint32_t)t);
-            uart_puts("\r\n");
+    /* Nothing to switch between until scheduler_start() */
+    if (!sched.current) return;
 
-            t->state = TASK_READY;
+    STATS_TICK_BEGIN();
 
-            // Remove from sleep list
-            if (t->prev) t->prev->next = t->next;
-            if (t->next) t->next->prev = t->prev;
-            if (sched.sleep_head == t) sched.sleep_head = t->next;
-            t->next = t->prev = NULL;
+    /* --- Wake sleeping tasks (queue is sorted, only pop expired) --- */
+    task_t *t;
+    while ((t = sched.sleep_head) &&
+           (int32_t)(t->wake_tick - sched.tick) <= 0) {
+        TRACE_DBG(TRACE_EV_WAKE, t, 0);
 
-            // Add back to ready queue
-            ready_enqueue(t);
-        }
-        t = next;
+        sched.sleep_head = t->wake_next;
+        if (sched.sleep_head) sched.sleep_head->wake_prev = NULL;
+        else sched.sleep_tail = NULL;
+        t->wake_next = t->wake_prev = NULL;
+
+        // Blocking call with a timeout: give up the wait
+        if (t->wait_q) wait_queue_remove(t->wait_q, t);
+        t->wait_result = SCHED_WAIT_TIMEOUT;
+
+        t->state = TASK_READY;
+        ready_enqueue(t);
     }
 
-    /* --- Round-robin selection --- */
+    /* Software timers: the batch goes to the timer-service task */
+    swtimer_tick(sched.tick);
+
+    /* Equal-priority peers only take over once the slice is used up */
     task_t *curr = sched.current;
+    schedule(curr->quantum && sched.tick - sched.slice_start >= curr->quantum);
+    STATS_TICK_END();
+}
 
-    if (curr && curr->state == TASK_RUNNING) {
-        uart_puts(" Current task still running: ");
-        uart_puthex((uint32_t)curr);
-        uart_puts(" (moving to back of queue)\r\n");
+/*
+ * --- Pick the next task and request the switch ---
+ * Called from the tick IRQ and from SVC (IRQs masked). A still running
+ * current task goes to the back of its queue when something outranks it,
+ * or when `rotate` lets an equal-priority peer have its turn; the switch
+ * itself is done by the exception exit path in startup.S.
+ */
+static void schedule(int rotate) {
+    task_t *curr = sched.current;
+    task_t *next_task;
 
-        curr->state = TASK_READY;
-        ready_enqueue(curr); // safe, it's not in the queue anymore
+    int keep = curr->state == TASK_RUNNING && !ready_outranks(curr, rotate);
+    if (!keep && curr->state == TASK_RUNNING && sched.lock_depth) {
+        /* sched_lock(): switch at the outermost sched_unlock() */
+        sched.lock_pending = 1;
+        keep = 1;
     }
 
-    task_t *next_task = pick_next_task();
-    if (!next_task) {
-        uart_puts(" No next task found, staying idle.\r\n");
-        return;
+    if (keep) {
+        /* Fast path: still the best candidate, no queue traffic */
+        next_task = curr;
+    } else {
+        if (curr->state == TASK_RUNNING) {
+            TRACE_DBG(TRACE_EV_PREEMPT, curr, 0);
+
+            curr->state = TASK_READY;
+            if (curr != sched.idle)
+                ready_enqueue(curr); // safe, the running task is never queued
+        }
+
+        next_task = pick_next_task();
+        if (!next_task) next_task = sched.idle;
+        if (!next_task) {
+            TRACE_ERR(TRACE_EV_NO_TASK, curr, 0);
+            return;
+        }
+
+        sched.current = next_task;
+        next_task->state = TASK_RUNNING;
+        sched.slice_start = sched.tick;
+    }
+
+    /*
+     * Tickless idle: with only the idle task to run, the next interrupt
+     * is needed at the earliest wakeup or software timer expiry. Every
+     * other task runs on 1-tick periods.
+     */
+    uint32_t period = 1;
+    if (next_task == sched.idle) {
+        period = TICKLESS_MAX_TICKS;
+        if (sched.sleep_head) {
+            int32_t delta = (int32_t)(sched.sleep_head->wake_tick - sched.tick);
+            if (delta < 1) delta = 1;
+            if ((uint32_t)delta < period) period = (uint32_t)delta;
+        }
+        uint32_t timer_left = swtimer_ticks_left(sched.tick);
+        if (timer_left < period) period = timer_left;
     }
+    if (period != sched.tick_period) {
+        TRACE_DBG(TRACE_EV_TICKLESS, period, 0);
+        sched.tick += tick_timer_set(period);
+        sched.tick_period = period;
+    }
+
+    /* request a context switch: the IRQ exit path in startup.S performs it */
+    svc_switch_to = next_task;
+
+    if (next_task != curr) {
+        /* One load per switch: has the outgoing task run off its stack? */
+        stack_check(curr);
+        TRACE_DBG(TRACE_EV_SWITCH, curr, next_task);
+        STATS_SWITCH(curr, next_task);
+    }
+}
+
+/*
+ * --- Ready queue helpers ---
+ * Invariant: ready lists hold exactly the TASK_READY tasks, and bit p of
+ * ready_bitmap is set iff ready_head[p] is non-empty. The running task is
+ * never queued, so picking is a bit scan plus a head pop.
+ */
+/*
+ * EDF order: a task with a deadline runs before one without, earlier
+ * absolute deadlines (wrap-safe) first.
+ */
+static inline int edf_before(const task_t *a, const task_t *b) {
+    if (!a->period) return 0;
+    if (!b->period) return 1;
+    return (int32_t)(a->abs_deadline - b->abs_deadline) < 0;
+}
 
-    sched.current = next_task;
-    next_task->state = TASK_RUNNING;
-
-    /* request a context switch: the assembly SVC wrapper will perform it */
-    svc_switch_from = curr;
-    svc_switch_to   = next_task;
-    
-    uart_puts("TASK DATA:\r\n");
-    uart_puts("CURR:   ");
-    uart_puthex((uint32_t)curr);
-    uart_puts("\r\n");
-    uart_puts("NEXT:   ");
-    uart_puthex((uint32_t)next_task);
-    uart_puts("\r\n");
-
-    uart_puts("STUFF:\r\n");
-    uart_puts("CURR SP:   ");
-    uart_puthex((uint32_t)curr->sp);
-    uart_puts("\r\n");
-    uart_puts("CURR LR:   ");
-    uart_puthex((uint32_t)curr->lr);
-    uart_puts("\r\n");
-
-    uart_puts("STUFF:\r\n");
-    uart_puts("NEXT SP:   ");
-    uart_puthex((uint32_t)next_task->sp);
-    uart_puts("\r\n");
-    uart_puts("NEXT LR:   ");
-    uart_puthex((uint32_t)next_task->lr);
-    uart_puts("\r\n");
-}
-
-/* --- Ready queue helpers --- */
 static void ready_enqueue(task_t *t) {
     uint8_t p = t->priority & 31;
-    t->next = t->prev = NULL;
-    if (!sched.ready_head[p]) {
-        sched.ready_head[p] = sched.ready_tail[p] = t;
-        sched.ready_bitmap |= (1u << p);
-    } else {
-        t->prev = sched.ready_tail[p];
-        sched.ready_tail[p]->next = t;
-        sched.ready_tail[p] = t;
-    }
+    task_t *after = sched.ready_tail[p];
+
+    // EDF level: behind the last task whose deadline is not later (scanning
+    // from the tail, the common case for a fresh release is O(1))
+    if (sched.edf_levels & (1u << p))
+        while (after && edf_before(t, after)) after = after->prev;
+
+    t->prev = after;
+    t->next = after ? after->next : sched.ready_head[p];
+    if (t->prev) t->prev->next = t;
+    else sched.ready_head[p] = t;
+    if (t->next) t->next->prev = t;
+    else sched.ready_tail[p] = t;
+
+    sched.ready_bitmap |= (1u << p);
 }
 
 static void ready_dequeue(task_t *t) {
     uint8_t p = t->priority & 31;
-    if (!sched.ready_head[p]) return;
 
     if (t->prev) t->prev->next = t->next;
     else sched.ready_head[p] = t->next;
@@ -287,28 +798,268 @@ static void ready_dequeue(task_t *t) {
     if (!sched.ready_head[p]) sched.ready_bitmap &= ~(1u << p);
 }
 
+/* Highest ready priority (lowest set bit); ready_bitmap must be non-zero */
+static inline uint32_t ready_best(void) {
+    uint32_t bits = sched.ready_bitmap;
+    return 31 - __builtin_clz(bits & -bits);  // ctz via ARMv5 clz
+}
+
+/*
+ * Does the best ready task take the CPU from the running task? Across
+ * priorities the higher one wins; at the same fixed priority only when
+ * `rotate` gives a peer its turn; on an EDF level an earlier deadline
+ * preempts and equal deadlines take turns.
+ */
+static inline int ready_outranks(task_t *curr, int rotate) {
+    if (!sched.ready_bitmap) return 0;
+
+    uint32_t best = ready_best();
+    if (best != curr->priority) return best < curr->priority;
+    if (!(sched.edf_levels & (1u << best))) return rotate;
+
+    task_t *head = sched.ready_head[best];
+    return edf_before(head, curr) || (rotate && !edf_before(curr, head));
+}
+
 static task_t *pick_next_task(void) {
     if (!sched.ready_bitmap) return NULL;
-    uint32_t bits = sched.ready_bitmap;
-    while (bits) {
-        uint8_t p = __builtin_ctz(bits);
-        bits &= ~(1u << p);
-        task_t *cur = sched.ready_head[p];
-        while (cur) {
-            if (cur->state == TASK_READY) {
-                ready_dequeue(cur);   // remove before returning
-                return cur;
+
+    uint32_t p = ready_best();
+    task_t *t = sched.ready_head[p];
+
+    // Pop the head
+    sched.ready_head[p] = t->next;
+    if (t->next) t->next->prev = NULL;
+    else {
+        sched.ready_tail[p] = NULL;
+        sched.ready_bitmap &= ~(1u << p);
+    }
+    t->next = NULL;
+    return t;
+}
+
+/* --- Wait queues, highest priority first, FIFO among equals --- */
+static void wait_queue_insert(wait_queue_t *wq, task_t *t) {
+    task_t *prev = NULL;
+    task_t *cur = wq->head;
+
+    while (cur && cur->priority <= t->priority) {
+        prev = cur;
+        cur = cur->next;
+    }
+
+    t->prev = prev;
+    t->next = cur;
+    if (cur) cur->prev = t;
+    if (prev) prev->next = t;
+    else wq->head = t;
+}
+
+static void wait_queue_remove(wait_queue_t *wq, task_t *t) {
+    if (t->prev) t->prev->next = t->next;
+    else wq->head = t->next;
+    if (t->next) t->next->prev = t->prev;
+
+    t->next = t->prev = NULL;
+    t->wait_q = NULL;
+}
+
+task_t *wait_queue_pop(wait_queue_t *wq) {
+    task_t *t = wq->head;
+    if (t) wait_queue_remove(wq, t);
+    return t;
+}
+
+/*
+ * --- Wakeup queue insert, sorted by absolute wake_tick ---
+ * Searched from the tail: tasks sleeping the same period land at or near
+ * the end, and equal deadlines keep FIFO order.
+ */
+static void sleep_enqueue(task_t *t) {
+    task_t *prev = sched.sleep_tail;
+
+    while (prev && (int32_t)(prev->wake_tick - t->wake_tick) > 0)
+        prev = prev->wake_prev;
+
+    task_t *next = prev ? prev->wake_next : sched.sleep_head;
+    t->wake_prev = prev;
+    t->wake_next = next;
+    if (next) next->wake_prev = t;
+    else sched.sleep_tail = t;
+    if (prev) prev->wake_next = t;
+    else sched.sleep_head = t;
+}
+
+/* --- Cancel a pending wakeup (no-op if the task is not queued) --- */
+static void sleep_dequeue(task_t *t) {
+    if (!t->wake_prev && sched.sleep_head != t) return;
+
+    if (t->wake_prev) t->wake_prev->wake_next = t->wake_next;
+    else sched.sleep_head = t->wake_next;
+    if (t->wake_next) t->wake_next->wake_prev = t->wake_prev;
+    else sched.sleep_tail = t->wake_prev;
+
+    t->wake_next = t->wake_prev = NULL;
+}
+
+/* --- Leave tickless mode: account elapsed ticks, back to 1-tick periods --- */
+static void tick_resume_periodic(void) {
+    if (sched.tick_period == 1) return;
+    sched.tick += tick_timer_set(1);
+    sched.tick_period = 1;
+}
+
+#ifdef SCHED_SELFTEST
+/*
+ * --- Ready queue self-test ---
+ * Built with `make SELFTEST=1`. Checks the ready list invariant after
+ * every operation of a randomised enqueue/dequeue/pick sequence that keeps
+ * all 32 priorities populated.
+ */
+#define SELFTEST_TASKS  (2 * MAX_PRIORITIES)
+#define SELFTEST_ROUNDS (4000U)
+
+int sched_verify(void) {
+    for (uint32_t p = 0; p < MAX_PRIORITIES; p++) {
+        task_t *t = sched.ready_head[p];
+        uint32_t bit = (sched.ready_bitmap >> p) & 1;
+
+        if (bit != (t != NULL)) return -1;
+        if (!t && sched.ready_tail[p]) return -1;
+
+        task_t *prev = NULL;
+        for (; t; prev = t, t = t->next) {
+            if (t->state != TASK_READY || t->priority != p) return -1;
+            if (t->prev != prev || t == sched.current) return -1;
+            if ((sched.edf_levels & (1u << p)) && prev && edf_before(t, prev)) return -1;
+        }
+        if (sched.ready_tail[p] != prev) return -1;
+    }
+    return 0;
+}
+
+void sched_periodic_job_done(void) {
+    periodic_job_done(sched.current);
+}
+
+int sched_verify_tasks(void) {
+    if (sched_verify()) return -1;
+
+    task_t *curr = sched.current;
+    if (curr && curr->state != TASK_RUNNING) return -1;
+
+    // Wakeup queue: sorted by wake_tick, only sleepers and timed waits
+    task_t *prev = NULL;
+    for (task_t *t = sched.sleep_head; t; prev = t, t = t->wake_next) {
+        if (t->wake_prev != prev) return -1;
+        if (t->state != TASK_SLEEPING && t->state != TASK_BLOCKED) return -1;
+        if (prev && (int32_t)(t->wake_tick - prev->wake_tick) < 0) return -1;
+    }
+    if (sched.sleep_tail != prev) return -1;
+
+    // Every ready task but idle is queued, nothing else is
+    uint32_t ready = 0, queued = 0;
+    for (task_t *t = sched.tasks; t; t = t->all_next)
+        if (t->state == TASK_READY && t != sched.idle) ready++;
+    for (uint32_t p = 0; p < MAX_PRIORITIES; p++)
+        for (task_t *t = sched.ready_head[p]; t; t = t->next) queued++;
+    return ready == queued ? 0 : -1;
+}
+
+int sched_selftest(void) {
+    static task_t tasks[SELFTEST_TASKS];
+    uint32_t seed = 12345;
+    int queued[SELFTEST_TASKS];
+
+    // Needs empty ready lists (call before task_create)
+    if (sched.ready_bitmap) return -1;
+
+    // Exercise deadline ordering on the upper half of the priorities;
+    // every third task has no deadline
+    uint32_t edf_levels = sched.edf_levels;
+    sched.edf_levels = 0xFFFF0000U;
+
+    for (uint32_t i = 0; i < SELFTEST_TASKS; i++) {
+        tasks[i].priority = i % MAX_PRIORITIES;
+        tasks[i].period = i % 3;
+        tasks[i].abs_deadline = 0xFFFF0000U + (i * 7919U) % 131072U; // wraps
+        tasks[i].state = TASK_READY;
+        ready_enqueue(&tasks[i]);
+        queued[i] = 1;
+    }
+    if (sched.ready_bitmap != 0xFFFFFFFFU || sched_verify()) return -1;
+
+    for (uint32_t n = 0; n < SELFTEST_ROUNDS; n++) {
+        seed = seed * 1103515245U + 12345U;
+        uint32_t i = (seed >> 16) % SELFTEST_TASKS;
+        task_t *t = &tasks[i];
+
+        switch ((seed >> 8) & 3) {
+        case 0:     // pick must return the best queued priority
+        {
+            uint32_t best = MAX_PRIORITIES;
+            for (uint32_t k = 0; k < SELFTEST_TASKS; k++)
+                if (queued[k] && tasks[k].priority < best) best = tasks[k].priority;
+
+            task_t *got = pick_next_task();
+            if (best == MAX_PRIORITIES) {
+                if (got) return -1;
+                break;
             }
-            cur = cur->next;
+            if (!got || got->priority != best) return -1;
+            queued[got - tasks] = 0;
+            break;
         }
+        case 1:     // remove from anywhere in a list
+            if (queued[i]) {
+                ready_dequeue(t);
+                queued[i] = 0;
+            }
+            break;
+        default:    // re-add, possibly at another priority
+            if (!queued[i]) {
+                t->priority = (seed >> 24) % MAX_PRIORITIES;
+                ready_enqueue(t);
+                queued[i] = 1;
+            }
+            break;
+        }
+
+        if (sched_verify()) return -1;
     }
-    return NULL;
+
+    // Drain and leave the scheduler as we found it
+    while (pick_next_task());
+    int rc = sched.ready_bitmap || sched_verify() ? -1 : 0;
+    sched.edf_levels = edf_levels;
+    return rc;
 }
+#endif /* SCHED_SELFTEST */
 
-/* --- Sleep list enqueue --- */
-static void sleep_enqueue(task_t *t) {
-    t->next = sched.sleep_head;
-    t->prev = NULL;
-    if (sched.sleep_head) sched.sleep_head->prev = t;
-    sched.sleep_head = t;
-}
\ No newline at end of file
+#ifdef SCHED_BENCH
+/*
+ * --- Ready queue microbenchmark ---
+ * Built into the `make bench` image. Each round queues one TCB at every
+ * priority and takes them back out best-first, so both the list links and
+ * the bitmap scan are exercised over all 32 priorities.
+ */
+uint32_t sched_bench_ready(uint32_t rounds) {
+    static task_t tasks[MAX_PRIORITIES];
+
+    // Needs empty ready lists (call before task_create)
+    if (sched.ready_bitmap) return 0;
+
+    for (uint32_t i = 0; i < MAX_PRIORITIES; i++) {
+        tasks[i].priority = MAX_PRIORITIES - 1 - i; // worst case: tail first
+        tasks[i].state = TASK_READY;
+    }
+
+    // IRQs are still masked from reset until scheduler_start()
+    uint32_t start = timestamp_us();
+    for (uint32_t n = 0; n < rounds; n++) {
+        for (uint32_t i = 0; i < MAX_PRIORITIES; i++) ready_enqueue(&tasks[i]);
+        while (pick_next_task());
+    }
+    return timestamp_us() - start;
+}
+#endif /* SCHED_BENCH */
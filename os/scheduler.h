@@ -2,6 +2,7 @@
 #define SCHEDULER_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 /**
  * @file scheduler.h
@@ -11,39 +12,228 @@
  * context switching.
  */
 
+struct task;
+
+/**
+ * @brief Queue of tasks blocked on a kernel object (semaphore, mutex, ...).
+ *
+ * Embedded in the object; kept in priority order by the scheduler.
+ * Zero-initialise (or use WAIT_QUEUE_INIT) before use.
+ */
+typedef struct {
+    struct task *head;
+} wait_queue_t;
+
+#define WAIT_QUEUE_INIT { 0 }
+
+#define SCHED_TICK_HZ_DEFAULT (1000U)
+
+/*
+ * Stack checking (`make STACKCHECK=0` to drop it): task_new() paints every
+ * stack with STACK_PAINT and puts STACK_CANARY in its lowest word, which
+ * is checked each time the task is switched out. A task that has used its
+ * stack to within one saved context of the canary is reported too.
+ */
+#ifndef SCHED_STACK_CHECK
+#define SCHED_STACK_CHECK 1
+#endif
+// Canaries the idle task checks per pass, going round all tasks in turn
+#ifndef SCHED_IDLE_STACK_CHECKS
+#define SCHED_IDLE_STACK_CHECKS (4U)
+#endif
+#define STACK_PAINT  (0xA5A5A5A5U)
+#define STACK_CANARY (0x5AC0FFEEU)
+
+/**
+ * @brief Scheduler configuration, passed to scheduler_init().
+ *
+ * A zeroed config runs at SCHED_TICK_HZ_DEFAULT with every priority FIFO.
+ */
+typedef struct {
+    uint32_t tick_hz;       // tick rate, 0 = SCHED_TICK_HZ_DEFAULT
+    /*
+     * Time slice in ticks for tasks created at each priority. Only
+     * equal-priority peers round-robin, and only when the slice ends;
+     * 0 runs the task until it blocks, yields or is preempted (FIFO).
+     */
+    uint16_t quantum[32];
+    /*
+     * Bit p makes priority p an earliest-deadline-first level: its ready
+     * tasks are ordered by absolute deadline (periodic tasks, see
+     * task_create_periodic(); others rank after them) and a newly ready
+     * earlier deadline preempts. Other priorities are unaffected, so
+     * fixed-priority tasks above and below the EDF band keep their
+     * precedence.
+     */
+    uint32_t edf_levels;
+} sched_config_t;
+
 /**
  * @brief Create and register a new task with the scheduler.
  *
- * The user does not see or manipulate the task control block (TCB).
+ * The user does not see or manipulate the task control block (TCB); it is
+ * taken from a kernel pool and returned as an opaque handle.
  *
- * @param func      Task entry function (no arguments, never returns).
- * @param stack     Pointer to caller-allocated stack memory (array of uint32_t).
- * @param size      Size of the stack array in words (uint32_t).
+ * @param func      Task entry function (no arguments). Returning from it is
+ *                  the same as calling task_exit().
+ * @param stack     Pointer to caller-allocated stack memory (array of uint32_t),
+ *                  or NULL to allocate one from the kernel heap.
+ * @param size      Size of the stack array in words (uint32_t). With a NULL
+ *                  stack, 0 selects the default (256 words).
  * @param priority  Task priority (0 = highest, 31 = lowest).
  *
- * @note Automatically registers the task with the scheduler.
+ * @return Task handle, or NULL if out of memory.
+ *
+ * @note Automatically registers the task with the scheduler. Called from a
+ *       running task, a higher-priority new task runs before this returns.
+ */
+struct task *task_create(void (*func)(void),
+                         uint32_t *stack,
+                         uint32_t size,
+                         uint8_t priority);
+
+/**
+ * @brief Overrun counters of a periodic task (see task_period_stats()).
+ */
+typedef struct {
+    uint32_t jobs;              // completed jobs
+    uint32_t deadline_misses;   // completed after their deadline
+    uint32_t skipped;           // releases dropped while a job overran
+} task_period_stats_t;
+
+/**
+ * @brief Create a task that runs a job once per period.
+ *
+ * Releases are at first_release + n * period (the first one immediately),
+ * so the rate does not drift with the job's run time. @p job is called
+ * once per release and returns when the job is done; the task then sleeps
+ * until the next release. Releases that pass while a job is still running
+ * are skipped and counted.
+ *
+ * Stack and priority parameters are as for task_create(). At a priority
+ * in sched_config_t.edf_levels the task is scheduled by its deadline.
+ * For sub-millisecond periods raise sched_config_t.tick_hz.
+ *
+ * @param period   Release interval in ticks (> 0).
+ * @param deadline Deadline in ticks after each release, 0 or >= period
+ *                 means the end of the period.
+ * @return Task handle, or NULL on bad arguments or out of memory.
  */
-void task_create(void (*func)(void),
-                 uint32_t *stack,
-                 uint32_t size,
-                 uint8_t priority);
+struct task *task_create_periodic(void (*job)(void), uint32_t *stack, uint32_t size,
+                                  uint8_t priority, uint32_t period, uint32_t deadline);
+
+/**
+ * @brief Read a periodic task's job and overrun counters.
+ *
+ * @return 0 on success, -1 if @p t is not a periodic task.
+ */
+int task_period_stats(struct task *t, task_period_stats_t *out);
+
+/**
+ * @brief Deepest stack use of a task so far, in words.
+ *
+ * Counts the painted words never overwritten, so it is only as exact as
+ * the deepest frame happened to be dirty. Equals the stack size once the
+ * canary was hit. Returns 0 with STACKCHECK=0.
+ */
+uint32_t task_stack_high_water(struct task *t);
+
+/**
+ * @brief Stop a task and recycle its TCB (and its stack, if the kernel
+ * allocated it).
+ *
+ * Passing the calling task is the same as task_exit(). Mutexes it holds
+ * pass to their best waiters (or become free), and the owner of a mutex
+ * it waits for drops the priority inherited from it. Task context only.
+ *
+ * @return 0 on success, -1 for an already stopped task.
+ */
+int task_delete(struct task *t);
+
+/**
+ * @brief End the calling task.
+ *
+ * Releases its mutexes, moves it to TASK_STOPPED and switches away; the
+ * TCB and stack are recycled on a later task_create()/task_delete().
+ * Does not return.
+ */
+void task_exit(void) __attribute__((noreturn));
 
 /**
  * @brief Put the current task to sleep for a given number of milliseconds.
  *
  * The task will be removed from the ready queue and not scheduled until the
- * specified time has passed.
+ * specified time has passed. The CPU is handed to the next task immediately.
  *
  * @param ms Sleep duration in milliseconds.
  */
 void sleep(uint32_t ms);
 
 /**
- * @brief Initialize the scheduler internals.
+ * @brief Sleep until an absolute tick (see scheduler_ticks()).
+ *
+ * Advancing the target by a fixed step each iteration gives a loop rate
+ * that does not drift. Returns at once if the tick is not in the future.
+ */
+void sleep_until(uint32_t tick);
+
+/**
+ * @brief Delay with microsecond resolution.
+ *
+ * Sleeps until the last tick boundary before the deadline (counting from
+ * the time already gone in the current tick), then busy-waits on the
+ * board's microsecond timestamp for the rest, less than one tick. Before
+ * scheduler_start() the whole delay is a busy-wait.
+ */
+void sleep_us(uint32_t us);
+
+/**
+ * @brief Give up the CPU to the next ready task.
+ *
+ * The current task goes to the back of its priority queue and the switch
+ * happens immediately through the SVC path in startup.S. Returns when the
+ * task is scheduled again (at once if it is the only ready task).
+ */
+void yield(void);
+
+/**
+ * @brief Keep the calling task on the CPU without masking interrupts.
+ *
+ * Nests. IRQ handlers still run and may wake tasks, but any switch away
+ * from the caller (preemption, time slice, yield) waits for the matching
+ * outermost sched_unlock(). Protects data shared only between tasks at
+ * no cost to IRQ latency. The caller must not block or sleep while it
+ * holds the lock. Task context only.
+ */
+void sched_lock(void);
+
+/**
+ * @brief Undo one sched_lock(); the outermost call performs a switch
+ * deferred meanwhile.
+ */
+void sched_unlock(void);
+
+/**
+ * @brief Initialize the scheduler internals and start the tick timer.
  *
  * Call this before adding any tasks.
+ *
+ * @param cfg Tick rate and time slices, copied. NULL selects 1000 Hz with
+ *            a 1-tick round-robin at every priority.
+ */
+void scheduler_init(const sched_config_t *cfg);
+
+/**
+ * @brief Override a task's time slice (default: its priority's quantum).
+ *
+ * @param ticks Slice length in ticks, 0 for FIFO (run to block).
+ */
+void task_set_quantum(struct task *t, uint32_t ticks);
+
+/**
+ * @brief Convert milliseconds to ticks at the configured rate, rounding up.
  */
-void scheduler_init(void);
+uint32_t scheduler_ms_to_ticks(uint32_t ms);
 
 /**
  * @brief Start the scheduler.
@@ -64,4 +254,114 @@ void scheduler_start(void);
  */
 void scheduler_tick(void);
 
+/**
+ * @brief Get the absolute tick count since scheduler_init().
+ *
+ * Exact: from a task it ends a stretched tickless period first. From an
+ * exception handler the timer is left alone and the ticks gone in that
+ * period are read off it instead.
+ */
+uint32_t scheduler_ticks(void);
+
+/* Idle hooks that fit in scheduler_idle_hook() */
+#define SCHED_IDLE_HOOKS (4U)
+
+/**
+ * @brief Run a function in the idle task.
+ *
+ * scheduler_init() creates the idle task below every priority. Whenever
+ * nothing else is ready it recycles exited tasks, checks the next
+ * SCHED_IDLE_STACK_CHECKS stack canaries, calls the hooks in registration
+ * order and then waits for the next interrupt (CP15 WFI). Hooks run with
+ * IRQs enabled, are preempted by any task that becomes ready and must not
+ * block.
+ *
+ * @return 0, or -1 if all SCHED_IDLE_HOOKS slots are taken.
+ */
+int scheduler_idle_hook(void (*hook)(void));
+
+#ifdef SCHED_SELFTEST
+/**
+ * @brief Check the ready list / ready_bitmap invariant.
+ *
+ * @return 0 if consistent, -1 otherwise.
+ */
+int sched_verify(void);
+
+/**
+ * @brief sched_verify() plus the wakeup queue order and the state of
+ * every live task (use on real tasks, not during sched_selftest()).
+ *
+ * @return 0 if consistent, -1 otherwise.
+ */
+int sched_verify_tasks(void);
+
+/**
+ * @brief End the current job of the running periodic task, as its entry
+ * loop does when the job function returns (for hosted tests, which do not
+ * run task code).
+ */
+void sched_periodic_job_done(void);
+
+/**
+ * @brief Randomised ready queue stress test over all 32 priorities.
+ *
+ * Call after scheduler_init() and before creating tasks.
+ *
+ * @return 0 on success, -1 on the first inconsistency.
+ */
+int sched_selftest(void);
+#endif
+
+#ifdef SCHED_BENCH
+/**
+ * @brief Time `rounds` x 32 ready queue enqueue + pick pairs.
+ *
+ * Call after scheduler_init() and before creating tasks.
+ *
+ * @return Elapsed microseconds, 0 if the ready lists were not empty.
+ */
+uint32_t sched_bench_ready(uint32_t rounds);
+#endif
+
+/**
+ * @brief Start the periodic tick timer (board support, see drivers/board.c).
+ *
+ * Called once by scheduler_init(); the first tick is not serviced before
+ * IRQs are enabled by scheduler_start().
+ *
+ * @param hz Tick rate.
+ */
+void tick_timer_init(uint32_t hz);
+
+/**
+ * @brief Reprogram the tick timer period (board support, see drivers/board.c).
+ *
+ * Called by the scheduler with IRQs masked to stretch the timer while
+ * only the idle task is runnable (tickless idle) and to restore 1-tick periods.
+ * The new period starts now, carrying over any partial tick.
+ *
+ * @param ticks New period in ticks (1 .. 1000).
+ * @return Whole ticks elapsed in the period being replaced.
+ */
+uint32_t tick_timer_set(uint32_t ticks);
+
+/**
+ * @brief Time into the current tick timer period (board support, see
+ * drivers/board.c).
+ *
+ * Read-only: the timer is not reprogrammed. Includes an expiry that is
+ * pending but not yet serviced. IRQs masked.
+ *
+ * @return Microseconds since the period began.
+ */
+uint32_t tick_timer_elapsed_us(void);
+
+/**
+ * @brief Free-running microsecond timestamp (board support, see drivers/board.c).
+ *
+ * Wraps every 2^32 us; compare timestamps by subtraction only.
+ */
+uint32_t timestamp_us(void);
+
 #endif // SCHEDULER_H
\ No newline at end of file
@@ -0,0 +1,219 @@
+#include "kernel.h"
+#include "uart.h"
+#include "critical.h"
+
+#if SCHED_STATS
+
+/* Tasks shown by sched_stats_dump(), idle included; the rest are counted */
+#ifndef STATS_MAX_TASKS
+#define STATS_MAX_TASKS (32U)
+#endif
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t sum;
+    uint32_t hist[STATS_BUCKETS];
+} stats_hist_t;
+
+static struct {
+    uint32_t start;        // beginning of the measurement window
+    uint32_t last_switch;  // charged to the running task at switch-out
+    uint32_t switches;
+    uint32_t tick_start;
+    uint32_t expiry;       // Timer0 expiry of the IRQ being handled
+    uint8_t timed_irq;     // stats_irq_enter() ran for this IRQ
+    stats_hist_t tick;
+    stats_hist_t latency;
+} stats;
+
+/* --- Histogram: bucket 0 is <1 us, bucket n covers [2^(n-1), 2^n) --- */
+static void hist_record(stats_hist_t *h, uint32_t us) {
+    uint32_t b = us ? 32 - __builtin_clz(us) : 0;
+    if (b >= STATS_BUCKETS) b = STATS_BUCKETS - 1;
+    h->hist[b]++;
+
+    if (!h->count || us < h->min) h->min = us;
+    if (us > h->max) h->max = us;
+    h->sum += us;
+    h->count++;
+}
+
+/* --- Kernel hooks (IRQs masked) --- */
+void stats_switch(struct task *from, struct task *to) {
+    uint32_t now = timestamp_us();
+
+    if (from) from->run_time += now - stats.last_switch;
+    stats.last_switch = now;
+    to->run_count++;
+    stats.switches++;
+}
+
+void stats_tick_begin(void) {
+    stats.tick_start = timestamp_us();
+}
+
+void stats_tick_end(void) {
+    hist_record(&stats.tick, timestamp_us() - stats.tick_start);
+}
+
+void stats_irq_enter(uint32_t expiry) {
+    stats.expiry = expiry;
+    stats.timed_irq = 1;
+}
+
+void stats_irq_exit(void) {
+    if (!stats.timed_irq) return;
+    stats.timed_irq = 0;
+    hist_record(&stats.latency, timestamp_us() - stats.expiry);
+}
+
+/* --- Reporting (task context) --- */
+void sched_stats_reset(void) {
+    irq_flags_t flags = irq_save();
+    for (task_t *t = sched_task_list(); t; t = t->all_next) {
+        t->run_time = 0;
+        t->run_count = 0;
+    }
+    uint32_t now = timestamp_us();
+    stats.start = stats.last_switch = now;
+    stats.switches = 0;
+    stats.tick = (stats_hist_t){ 0 };
+    stats.latency = (stats_hist_t){ 0 };
+    irq_restore(flags);
+}
+
+/* Snapshot taken with IRQs masked, printed afterwards */
+static struct snap_entry {
+    task_t *task;
+    uint32_t run_time;
+    uint32_t run_count;
+    uint32_t stack_size;
+    uint32_t stack_used;
+    uint8_t priority;
+    uint8_t state;
+} snap[STATS_MAX_TASKS];
+
+static stats_hist_t snap_tick, snap_latency;
+
+static void snap_task(struct snap_entry *s, task_t *t, task_t *curr, uint32_t now) {
+    s->task = t;
+    s->run_time = t->run_time;
+    if (t == curr) s->run_time += now - stats.last_switch;
+    s->run_count = t->run_count;
+    s->stack_size = t->stack_size;
+    s->priority = t->priority;
+    s->state = (uint8_t)t->state;
+}
+
+static void hist_print(const char *name, const stats_hist_t *h) {
+    uart_puts(name);
+    uart_puts(" n=");
+    uart_putdec(h->count);
+    uart_puts(" min=");
+    uart_putdec(h->min);
+    uart_puts(" avg=");
+    uart_putdec(h->count ? h->sum / h->count : 0);
+    uart_puts(" max=");
+    uart_putdec(h->max);
+    uart_puts(" us\r\n ");
+    for (uint32_t b = 0; b < STATS_BUCKETS; b++) {
+        uart_puts(" ");
+        if (b) {
+            uart_putdec(1U << (b - 1));
+            uart_puts(b == STATS_BUCKETS - 1 ? "+:" : ":");
+        } else {
+            uart_puts("<1:");
+        }
+        uart_putdec(h->hist[b]);
+    }
+    uart_puts("\r\n");
+}
+
+void sched_stats_dump(void) {
+    static const char *const state_names[] = {
+        [TASK_READY] = "ready", [TASK_RUNNING] = "run", [TASK_SLEEPING] = "sleep",
+        [TASK_BLOCKED] = "block", [TASK_STOPPED] = "stop",
+    };
+    uint32_t n = 0, more = 0;
+
+    // Only tasks free TCBs: keep them out until the stack scans are done
+    sched_lock();
+    irq_flags_t flags = irq_save();
+    uint32_t now = timestamp_us();
+    task_t *curr = sched_current();
+    task_t *idle = sched_idle_task();
+
+    // Idle (last on the list) always gets a row: it gives the CPU load
+    for (task_t *t = sched_task_list(); t; t = t->all_next) {
+        if (t == idle) continue;
+        if (n < STATS_MAX_TASKS - 1) snap_task(&snap[n++], t, curr, now);
+        else more++;
+    }
+    if (idle) snap_task(&snap[n++], idle, curr, now);
+    uint32_t elapsed = now - stats.start;
+    uint32_t switches = stats.switches;
+    snap_tick = stats.tick;
+    snap_latency = stats.latency;
+    irq_restore(flags);
+
+    // Stack scans with IRQs enabled, still under the lock
+    for (uint32_t i = 0; i < n; i++) snap[i].stack_used = task_stack_high_water(snap[i].task);
+    sched_unlock();
+
+    uart_puts("sched stats: ");
+    uart_putdec(elapsed);
+    uart_puts(" us, ");
+    uart_putdec(switches);
+    uart_puts(" switches\r\n");
+
+    uart_puts("  task       prio state runtime_us cpu% runs stack_used/size\r\n");
+    for (uint32_t i = 0; i < n; i++) {
+        uart_puts("  ");
+        uart_puthex((uint32_t)(uintptr_t)snap[i].task);
+        uart_puts(" ");
+        uart_putdec(snap[i].priority);
+        uart_puts(" ");
+        uart_puts(state_names[snap[i].state]);
+        uart_puts(" ");
+        uart_putdec(snap[i].run_time);
+        uart_puts(" ");
+        uart_putdec(elapsed >= 100 ? snap[i].run_time / (elapsed / 100) : 0);
+        uart_puts(" ");
+        uart_putdec(snap[i].run_count);
+        uart_puts(" ");
+        uart_putdec(snap[i].stack_used);
+        uart_puts("/");
+        uart_putdec(snap[i].stack_size);
+        if (snap[i].stack_used >= snap[i].stack_size) uart_puts(" OVERFLOW");
+        uart_puts("\r\n");
+    }
+    if (more) {
+        uart_puts("  +");
+        uart_putdec(more);
+        uart_puts(" more tasks\r\n");
+    }
+
+    // Idle time is what is left over: the CPU load is the rest
+    for (uint32_t i = 0; i < n; i++) {
+        if (snap[i].task != idle || elapsed < 100) continue;
+        uint32_t idle_pct = snap[i].run_time / (elapsed / 100);
+        uart_puts("  cpu load ");
+        uart_putdec(idle_pct < 100 ? 100 - idle_pct : 0);
+        uart_puts("%\r\n");
+    }
+
+    hist_print("  tick   ", &snap_tick);
+    hist_print("  latency", &snap_latency);
+}
+
+#else /* !SCHED_STATS */
+
+void sched_stats_dump(void) {
+}
+
+void sched_stats_reset(void) {
+}
+
+#endif /* SCHED_STATS */
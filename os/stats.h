@@ -0,0 +1,73 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+/**
+ * @file stats.h
+ * @brief Scheduler profiling: per-task CPU time and IRQ latency.
+ *
+ * Timestamps come from the board's free-running timestamp_us() counter
+ * (Timer1 on versatilepb, 1 us resolution; the ARM926 has no cycle
+ * counter). Enabled with `make STATS=1` (the default); with STATS=0 the
+ * hooks compile away and the TCB loses its counters.
+ *
+ * Measured:
+ * - run time of every task, charged on each switch, and the CPU load
+ *   (everything but the idle task);
+ * - scheduler_tick() duration (wakeups, pick, timer reprogramming);
+ * - Timer0 expiry to the end of irq_handler(), i.e. what a task woken by
+ *   the tick waits before the exception exit path switches to it.
+ *
+ * The dump also lists each task's stack high-water mark against its size
+ * (task_stack_high_water(), needs STACKCHECK=1).
+ * It shows up to STATS_MAX_TASKS rows (32 unless defined otherwise), the
+ * idle task always among them, and counts the tasks left out.
+ *
+ * Counters are 32-bit microseconds and wrap after ~71 minutes; call
+ * sched_stats_reset() to start a new measurement window.
+ */
+
+#ifndef SCHED_STATS
+#define SCHED_STATS 1
+#endif
+
+/* Latency histogram buckets: <1, 1, 2-3, 4-7, ... , >=256 us */
+#define STATS_BUCKETS (10U)
+
+struct task;
+
+/**
+ * @brief Print per-task run time and the latency/tick histograms.
+ *
+ * Task context, polled UART output. Does nothing with STATS=0.
+ */
+void sched_stats_dump(void);
+
+/**
+ * @brief Clear all counters and start a new measurement window.
+ */
+void sched_stats_reset(void);
+
+/* --- Kernel hooks (IRQs masked), use the STATS_* macros --- */
+void stats_switch(struct task *from, struct task *to);
+void stats_tick_begin(void);
+void stats_tick_end(void);
+void stats_irq_enter(uint32_t expiry);   // timestamp_us() of the tick expiry
+void stats_irq_exit(void);
+
+#if SCHED_STATS
+#define STATS_SWITCH(from, to)  stats_switch((from), (to))
+#define STATS_TICK_BEGIN()      stats_tick_begin()
+#define STATS_TICK_END()        stats_tick_end()
+#define STATS_IRQ_ENTER(ts)     stats_irq_enter(ts)
+#define STATS_IRQ_EXIT()        stats_irq_exit()
+#else
+#define STATS_SWITCH(from, to)  ((void)0)
+#define STATS_TICK_BEGIN()      ((void)0)
+#define STATS_TICK_END()        ((void)0)
+#define STATS_IRQ_ENTER(ts)     ((void)0)
+#define STATS_IRQ_EXIT()        ((void)0)
+#endif
+
+#endif // STATS_H
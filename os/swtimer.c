@@ -0,0 +1,169 @@
+#include "kernel.h"
+#include "swtimer.h"
+#include "critical.h"
+
+#define WHEEL_MASK (SWTIMER_WHEEL_SLOTS - 1)
+
+static struct {
+    swtimer_t *wheel[SWTIMER_WHEEL_SLOTS];
+    uint32_t wheel_tick;        // last tick the wheel was advanced to
+    uint32_t armed;             // timers on the wheel
+    uint32_t next;              // earliest expiry, may be early after a stop
+    swtimer_t *batch_head;      // expired, oldest first
+    swtimer_t *batch_tail;
+    wait_queue_t service;       // the service task, while idle
+} swt;
+
+/* --- Wheel (IRQs masked) --- */
+static void wheel_insert(swtimer_t *t) {
+    swtimer_t **slot = &swt.wheel[t->expires & WHEEL_MASK];
+
+    t->prev = NULL;
+    t->next = *slot;
+    if (*slot) (*slot)->prev = t;
+    *slot = t;
+    t->armed = 1;
+
+    if (!swt.armed++ || (int32_t)(t->expires - swt.next) < 0) swt.next = t->expires;
+}
+
+static void wheel_remove(swtimer_t *t) {
+    if (t->prev) t->prev->next = t->next;
+    else swt.wheel[t->expires & WHEEL_MASK] = t->next;
+    if (t->next) t->next->prev = t->prev;
+
+    t->next = t->prev = NULL;
+    t->armed = 0;
+    swt.armed--;
+}
+
+/*
+ * Exact next expiry once the cached one has passed. Slot now + d only
+ * holds timers due at now + d or later, so the scan walks forward and
+ * stops as soon as the earliest expiry seen cannot be beaten: usually
+ * at the first non-empty slot. Only when every timer is a wheel turn or
+ * more away does it visit them all.
+ */
+static void wheel_find_next(uint32_t now) {
+    uint32_t best = 0;
+    int found = 0;
+
+    for (uint32_t d = 1; d <= SWTIMER_WHEEL_SLOTS; d++) {
+        if (found && (int32_t)(best - (now + d)) < 0) break;
+        for (swtimer_t *t = swt.wheel[(now + d) & WHEEL_MASK]; t; t = t->next) {
+            if (!found || (int32_t)(t->expires - best) < 0) best = t->expires;
+            found = 1;
+        }
+    }
+    swt.next = best;
+}
+
+/* Queue the callback; periodic timers go straight back on the wheel */
+static void timer_expire(swtimer_t *t, uint32_t now) {
+    wheel_remove(t);
+
+    if (t->period) {
+        // Next point on the grid that is still ahead
+        do t->expires += t->period;
+        while ((int32_t)(t->expires - now) <= 0);
+        wheel_insert(t);
+    }
+
+    t->pending = 1;
+    if (t->in_batch) return;
+
+    t->in_batch = 1;
+    t->batch_next = NULL;
+    if (swt.batch_tail) swt.batch_tail->batch_next = t;
+    else swt.batch_head = t;
+    swt.batch_tail = t;
+}
+
+/* --- Kernel hooks --- */
+void swtimer_tick(uint32_t now) {
+    uint32_t elapsed = now - swt.wheel_tick;
+    swt.wheel_tick = now;
+    if (!swt.armed || (int32_t)(swt.next - now) > 0) return;
+
+    // Visit each slot passed since the last advance (at most once), oldest first
+    uint32_t slots = elapsed < SWTIMER_WHEEL_SLOTS ? elapsed : SWTIMER_WHEEL_SLOTS;
+    for (uint32_t i = slots; i-- > 0;) {
+        swtimer_t *t = swt.wheel[(now - i) & WHEEL_MASK];
+        while (t) {
+            swtimer_t *next = t->next;
+            if ((int32_t)(t->expires - now) <= 0) timer_expire(t, now);
+            t = next;
+        }
+    }
+    if (swt.armed) wheel_find_next(now);
+
+    // Hand the batch to the service task; scheduler_tick() switches
+    task_t *svc = swt.batch_head ? wait_queue_pop(&swt.service) : NULL;
+    if (svc) sched_wake(svc);
+}
+
+uint32_t swtimer_ticks_left(uint32_t now) {
+    if (!swt.armed) return UINT32_MAX;
+    int32_t left = (int32_t)(swt.next - now);
+    return left < 1 ? 1 : (uint32_t)left;
+}
+
+/* --- Service task: run expired callbacks with IRQs enabled --- */
+static void swtimer_service(void) {
+    for (;;) {
+        irq_flags_t flags = irq_save();
+        swtimer_t *t;
+        while (!(t = swt.batch_head)) sched_block(&swt.service);
+
+        swt.batch_head = t->batch_next;
+        if (!swt.batch_head) swt.batch_tail = NULL;
+        t->in_batch = 0;
+
+        int run = t->pending;   // swtimer_stop() may have dropped it
+        t->pending = 0;
+        void (*fn)(void *) = t->fn;
+        void *arg = t->arg;
+        irq_restore(flags);
+
+        if (run) fn(arg);
+    }
+}
+
+int swtimer_init(uint8_t priority) {
+    return task_create(swtimer_service, NULL, 0, priority) ? 0 : -1;
+}
+
+/* --- API --- */
+void swtimer_setup(swtimer_t *t, void (*fn)(void *arg), void *arg) {
+    *t = (swtimer_t)SWTIMER_INIT(fn, arg);
+}
+
+void swtimer_start_isr(swtimer_t *t, uint32_t ticks, uint32_t period) {
+    swtimer_stop_isr(t);
+
+    // Leaves a stretched tickless period, so the expiry counts from now
+    t->expires = sched_tick_sync() + (ticks ? ticks : 1);
+    t->period = period;
+    wheel_insert(t);
+}
+
+void swtimer_start(swtimer_t *t, uint32_t ticks, uint32_t period) {
+    irq_flags_t flags = irq_save();
+    swtimer_start_isr(t, ticks, period);
+    irq_restore(flags);
+}
+
+void swtimer_stop_isr(swtimer_t *t) {
+    if (t->armed) wheel_remove(t);
+    t->pending = 0;
+}
+
+void swtimer_stop(swtimer_t *t) {
+    irq_flags_t flags = irq_save();
+    swtimer_stop_isr(t);
+    irq_restore(flags);
+}
+
+int swtimer_active(const swtimer_t *t) {
+    return t->armed || t->pending;
+}
@@ -0,0 +1,88 @@
+#ifndef SWTIMER_H
+#define SWTIMER_H
+
+#include <stdint.h>
+
+/**
+ * @file swtimer.h
+ * @brief Software timers: one-shot and periodic callbacks on the tick.
+ *
+ * Timers are not tasks. They hang on a hashed timer wheel advanced by
+ * scheduler_tick() (insert and cancel are O(1), a tick only looks at the
+ * slots it passes, and the next expiry is found scanning forward from it). Expired timers are queued, and the timer-service task
+ * runs the whole batch with IRQs enabled, in expiry order. The scheduler's
+ * tickless period is capped at the next expiry, so armed timers fire on
+ * time and idle timers cost no ticks.
+ *
+ * Callbacks run in the service task: they may block briefly, but a slow
+ * callback delays every timer behind it.
+ */
+
+/* Wheel slots (power of two); timers further out wait extra rounds */
+#define SWTIMER_WHEEL_SLOTS 64U
+
+typedef struct swtimer {
+    struct swtimer *next;       // wheel slot list
+    struct swtimer *prev;
+    struct swtimer *batch_next; // expired, waiting for the service task
+    uint32_t expires;           // absolute tick
+    uint32_t period;            // ticks between periodic expiries, 0 = one-shot
+    void (*fn)(void *arg);
+    void *arg;
+    uint8_t armed;              // on the wheel
+    uint8_t in_batch;           // linked on the expired batch
+    uint8_t pending;            // callback due (cleared again by swtimer_stop)
+} swtimer_t;
+
+#define SWTIMER_INIT(fn, arg) { 0, 0, 0, 0, 0, (fn), (arg), 0, 0, 0 }
+
+/**
+ * @brief Create the timer-service task.
+ *
+ * Call once after scheduler_init(). Timers may be started before.
+ *
+ * @return 0 on success, -1 if the task could not be created.
+ */
+int swtimer_init(uint8_t priority);
+
+/**
+ * @brief Set up a stopped timer.
+ */
+void swtimer_setup(swtimer_t *t, void (*fn)(void *arg), void *arg);
+
+/**
+ * @brief (Re)arm a timer.
+ *
+ * A running timer is restarted; a callback still pending from an earlier
+ * expiry is dropped. Periodic timers keep a fixed grid of expiries: a
+ * period missed while the callback is still pending is not run twice.
+ * Task context only; use swtimer_start_isr() from interrupt handlers.
+ *
+ * @param ticks  First expiry in ticks from now (0 is treated as 1).
+ * @param period Interval for later expiries, 0 = one-shot.
+ */
+void swtimer_start(swtimer_t *t, uint32_t ticks, uint32_t period);
+
+/**
+ * @brief Disarm a timer and drop its pending callback.
+ *
+ * A callback already running completes. Task context only.
+ */
+void swtimer_stop(swtimer_t *t);
+
+/**
+ * @brief swtimer_start() / swtimer_stop() for IRQ context.
+ */
+void swtimer_start_isr(swtimer_t *t, uint32_t ticks, uint32_t period);
+void swtimer_stop_isr(swtimer_t *t);
+
+/**
+ * @brief Whether the timer is armed or its callback is pending.
+ */
+int swtimer_active(const swtimer_t *t);
+
+/* --- Kernel hooks (IRQs masked) --- */
+void swtimer_tick(uint32_t now);            // scheduler_tick(): expire up to now
+uint32_t swtimer_ticks_left(uint32_t now);  // until the next expiry, UINT32_MAX if none
+
+#endif // SWTIMER_H
@@ -0,0 +1,185 @@
+#include "sync.h"
+#include "kernel.h"
+#include "critical.h"
+
+/* --- Semaphores --- */
+void sem_init(sem_t *s, int32_t count) {
+    s->count = count;
+    s->waiters.head = NULL;
+}
+
+void sem_wait(sem_t *s) {
+    irq_flags_t flags = irq_save();
+    if (s->count > 0) {
+        s->count--;
+    } else {
+        // sem_post hands the count straight to us
+        sched_block(&s->waiters);
+    }
+    irq_restore(flags);
+}
+
+int sem_trywait(sem_t *s) {
+    int taken = 0;
+
+    irq_flags_t flags = irq_save();
+    if (s->count > 0) {
+        s->count--;
+        taken = 1;
+    }
+    irq_restore(flags);
+    return taken;
+}
+
+/* --- Release one unit (IRQs masked) --- */
+static void sem_release(sem_t *s) {
+    task_t *t = wait_queue_pop(&s->waiters);
+    if (!t) {
+        s->count++;
+        return;
+    }
+
+    sched_wake(t);
+    sched_preempt();
+}
+
+void sem_post(sem_t *s) {
+    irq_flags_t flags = irq_save();
+    sem_release(s);
+    irq_restore(flags);
+}
+
+void sem_post_isr(sem_t *s) {
+    sem_release(s);
+}
+
+/* --- Mutexes --- */
+void mutex_init(mutex_t *m) {
+    m->owner = NULL;
+    m->next_held = NULL;
+    m->waiters.head = NULL;
+}
+
+/* --- Owner bookkeeping --- */
+static void mutex_take(mutex_t *m, task_t *t) {
+    m->owner = t;
+    m->next_held = t->held;
+    t->held = m;
+}
+
+static void mutex_release_held(mutex_t *m, task_t *t) {
+    mutex_t **pp = &t->held;
+    while (*pp && *pp != m) pp = &(*pp)->next_held;
+    if (*pp) *pp = m->next_held;
+    m->next_held = NULL;
+}
+
+/* Effective priority: base, or the best waiter on any mutex we still hold */
+static uint8_t mutex_owner_priority(task_t *t) {
+    uint8_t p = t->base_priority;
+    for (mutex_t *m = t->held; m; m = m->next_held) {
+        task_t *w = m->waiters.head;
+        if (w && w->priority < p) p = w->priority;
+    }
+    return p;
+}
+
+/* Re-derive owner priorities along a chain after a waiter went away */
+static void mutex_unboost(mutex_t *m) {
+    while (m && m->owner) {
+        task_t *owner = m->owner;
+        uint8_t p = mutex_owner_priority(owner);
+        if (p == owner->priority) break;
+        sched_set_priority(owner, p);
+        m = owner->wait_mutex;
+    }
+}
+
+/* Boost owners along a chain of mutexes to the blocking task's priority */
+static void mutex_inherit(mutex_t *m, uint8_t priority) {
+    while (m && m->owner && priority < m->owner->priority) {
+        task_t *owner = m->owner;
+        sched_set_priority(owner, priority);
+        m = owner->wait_mutex;
+    }
+}
+
+void mutex_lock(mutex_t *m) {
+    irq_flags_t flags = irq_save();
+    task_t *t = sched_current();
+
+    if (!m->owner) {
+        mutex_take(m, t);
+    } else {
+        t->wait_mutex = m;
+        mutex_inherit(m, t->priority);
+
+        // mutex_unlock hands ownership straight to us
+        sched_block(&m->waiters);
+    }
+    irq_restore(flags);
+}
+
+int mutex_trylock(mutex_t *m) {
+    int taken = 0;
+
+    irq_flags_t flags = irq_save();
+    if (!m->owner) {
+        mutex_take(m, sched_current());
+        taken = 1;
+    }
+    irq_restore(flags);
+    return taken;
+}
+
+/* Ownership to the best waiter, which the remaining waiters then boost */
+static void mutex_handoff(mutex_t *m) {
+    task_t *next = wait_queue_pop(&m->waiters);
+    if (!next) {
+        m->owner = NULL;
+        return;
+    }
+
+    next->wait_mutex = NULL;
+    mutex_take(m, next);
+
+    task_t *w = m->waiters.head;
+    if (w && w->priority < next->priority)
+        sched_set_priority(next, w->priority);
+
+    sched_wake(next);
+}
+
+void mutex_unlock(mutex_t *m) {
+    irq_flags_t flags = irq_save();
+    task_t *t = sched_current();
+    if (m->owner != t) {
+        irq_restore(flags);
+        return;
+    }
+
+    mutex_release_held(m, t);
+    mutex_handoff(m);
+
+    // Drop any priority inherited through this mutex
+    sched_set_priority(t, mutex_owner_priority(t));
+
+    sched_preempt();
+    irq_restore(flags);
+}
+
+void mutex_release_all(task_t *t) {
+    mutex_t *m;
+    while ((m = t->held)) {
+        mutex_release_held(m, t);
+        mutex_handoff(m);
+    }
+}
+
+void mutex_cancel_wait(task_t *t) {
+    mutex_t *m = t->wait_mutex;
+    if (!m) return;
+
+    t->wait_mutex = NULL;
+    mutex_unboost(m);
+}
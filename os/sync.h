@@ -0,0 +1,95 @@
+#ifndef SYNC_H
+#define SYNC_H
+
+#include <stdint.h>
+#include "scheduler.h"
+
+/**
+ * @file sync.h
+ * @brief Counting semaphores and priority-inheritance mutexes.
+ *
+ * Waiters block in the scheduler (no polling) on a priority-ordered wait
+ * queue. Release hands the object directly to the best waiter, which runs
+ * at once if it outranks the releasing task.
+ */
+
+/* --- Counting semaphore --- */
+typedef struct {
+    int32_t count;
+    wait_queue_t waiters;
+} sem_t;
+
+/* --- Mutex (owner-only unlock, not recursive) --- */
+typedef struct mutex {
+    struct task *owner;
+    struct mutex *next_held;   // owner's list of held mutexes
+    wait_queue_t waiters;
+} mutex_t;
+
+#define SEM_INIT(n)  { (n), WAIT_QUEUE_INIT }
+#define MUTEX_INIT   { 0, 0, WAIT_QUEUE_INIT }
+
+/**
+ * @brief Initialise a semaphore with an initial count.
+ */
+void sem_init(sem_t *s, int32_t count);
+
+/**
+ * @brief Take the semaphore, blocking while the count is zero.
+ *
+ * Task context only.
+ */
+void sem_wait(sem_t *s);
+
+/**
+ * @brief Take the semaphore if available.
+ *
+ * @return 1 if taken, 0 if the count was zero.
+ */
+int sem_trywait(sem_t *s);
+
+/**
+ * @brief Release the semaphore, waking the highest-priority waiter.
+ *
+ * Task context only; use sem_post_isr() from interrupt handlers.
+ */
+void sem_post(sem_t *s);
+
+/**
+ * @brief sem_post() for IRQ context; a woken task that outranks the
+ * interrupted one runs on IRQ exit.
+ */
+void sem_post_isr(sem_t *s);
+
+/**
+ * @brief Initialise an unlocked mutex.
+ */
+void mutex_init(mutex_t *m);
+
+/**
+ * @brief Lock the mutex, blocking while another task owns it.
+ *
+ * The owner inherits the priority of its highest-priority waiter (also
+ * through chains of mutexes) until it unlocks. Task context only.
+ */
+void mutex_lock(mutex_t *m);
+
+/**
+ * @brief Lock the mutex if it is free.
+ *
+ * @return 1 if locked, 0 if owned by another task.
+ */
+int mutex_trylock(mutex_t *m);
+
+/**
+ * @brief Unlock a mutex held by the calling task.
+ *
+ * Ownership passes straight to the highest-priority waiter.
+ */
+void mutex_unlock(mutex_t *m);
+
+/* --- Kernel hooks for task_exit()/task_delete() (IRQs masked) --- */
+void mutex_release_all(struct task *t);     // hand every held mutex on
+void mutex_cancel_wait(struct task *t);     // t left a mutex wait queue
+
+#endif // SYNC_H
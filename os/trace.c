@@ -0,0 +1,80 @@
+#include "trace.h"
+#include "scheduler.h"
+#include "kernel.h"
+#include "uart.h"
+
+#if TRACE_LEVEL > TRACE_NONE
+
+static const char *const event_names[TRACE_EV_COUNT] = {
+    [TRACE_EV_TASK_CREATE] = "TASK ADDED",
+    [TRACE_EV_TASK_NOMEM]  = "TASK POOL FULL",
+    [TRACE_EV_TASK_EXIT]   = "TASK EXIT",
+    [TRACE_EV_START]       = "START",
+    [TRACE_EV_TICK]        = "TICK",
+    [TRACE_EV_WAKE]        = "WAKE",
+    [TRACE_EV_PREEMPT]     = "PREEMPT",
+    [TRACE_EV_SWITCH]      = "SWITCH",
+    [TRACE_EV_NO_TASK]     = "NO TASK",
+    [TRACE_EV_TICKLESS]    = "TICK PERIOD",
+    [TRACE_EV_STACK_OVF]   = "STACK OVERFLOW",
+};
+
+/* --- Format one event as "[tick] NAME a b" --- */
+static void trace_print(uint32_t tick, uint32_t event, uint32_t a, uint32_t b) {
+    uart_puts("[");
+    uart_putdec(tick);
+    uart_puts("] ");
+    uart_puts(event < TRACE_EV_COUNT ? event_names[event] : "?");
+    uart_puts(" ");
+    uart_puthex(a);
+    uart_puts(" ");
+    uart_puthex(b);
+    uart_puts("\r\n");
+}
+
+#if TRACE_MODE == TRACE_MODE_BINARY
+
+static trace_record_t trace_ring[TRACE_RING_SIZE];
+static uint32_t trace_head; /* total records written */
+
+void trace_emit(uint32_t event, uint32_t a, uint32_t b) {
+    trace_record_t *r = &trace_ring[trace_head & (TRACE_RING_SIZE - 1)];
+    r->tick = sched_tick_raw();
+    r->event = (uint16_t)event;
+    r->seq = (uint16_t)trace_head;
+    r->a = a;
+    r->b = b;
+    trace_head++;
+}
+
+void trace_dump(void) {
+    uint32_t end = trace_head;
+    uint32_t start = end > TRACE_RING_SIZE ? end - TRACE_RING_SIZE : 0;
+
+    for (uint32_t i = start; i != end; i++) {
+        const trace_record_t *r = &trace_ring[i & (TRACE_RING_SIZE - 1)];
+        trace_print(r->tick, r->event, r->a, r->b);
+    }
+}
+
+#else /* TRACE_MODE_TEXT */
+
+void trace_emit(uint32_t event, uint32_t a, uint32_t b) {
+    trace_print(sched_tick_raw(), event, a, b);
+}
+
+void trace_dump(void) {
+}
+
+#endif /* TRACE_MODE */
+
+#else /* TRACE_NONE */
+
+void trace_emit(uint32_t event, uint32_t a, uint32_t b) {
+    (void)event; (void)a; (void)b;
+}
+
+void trace_dump(void) {
+}
+
+#endif /* TRACE_LEVEL */
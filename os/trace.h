@@ -0,0 +1,92 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+/**
+ * @file trace.h
+ * @brief Compile-time leveled kernel trace.
+ *
+ * The level and output mode are chosen in the makefile
+ * (`make TRACE=none|error|debug TRACE_MODE=text|binary`). Trace points
+ * above TRACE_LEVEL compile away completely, so a TRACE=none build does
+ * no I/O on the tick path.
+ *
+ * - Text mode formats each event straight to the UART (slow, blocking).
+ * - Binary mode stores fixed-size records into a RAM ring buffer which
+ *   can be inspected with a debugger or printed later with trace_dump().
+ */
+
+#define TRACE_NONE  0
+#define TRACE_ERROR 1
+#define TRACE_DEBUG 2
+
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_NONE
+#endif
+
+#define TRACE_MODE_TEXT   0
+#define TRACE_MODE_BINARY 1
+
+#ifndef TRACE_MODE
+#define TRACE_MODE TRACE_MODE_TEXT
+#endif
+
+/* Number of records in the binary ring (power of two). */
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE 256U
+#endif
+
+/* --- Trace events --- */
+typedef enum {
+    TRACE_EV_TASK_CREATE,   /* a = task, b = entry */
+    TRACE_EV_TASK_NOMEM,    /* task pool exhausted */
+    TRACE_EV_TASK_EXIT,     /* a = task */
+    TRACE_EV_START,         /* a = first task, b = entry */
+    TRACE_EV_TICK,          /* a = tick */
+    TRACE_EV_WAKE,          /* a = task */
+    TRACE_EV_PREEMPT,       /* a = task moved to back of its queue */
+    TRACE_EV_SWITCH,        /* a = from, b = to */
+    TRACE_EV_NO_TASK,       /* nothing ready to run */
+    TRACE_EV_TICKLESS,      /* a = new timer period in ticks */
+    TRACE_EV_STACK_OVF,     /* a = task, b = what replaced the canary */
+    TRACE_EV_COUNT
+} trace_event_t;
+
+/* --- Binary record (16 bytes) --- */
+typedef struct {
+    uint32_t tick;
+    uint16_t event;
+    uint16_t seq;   /* wraps; gaps show overwritten records */
+    uint32_t a;
+    uint32_t b;
+} trace_record_t;
+
+/**
+ * @brief Emit one trace event. Use the TRACE_ERR/TRACE_DBG macros instead.
+ *
+ * Must be called with IRQs masked (from IRQ context or inside a critical
+ * section) so ring slots are never handed out twice.
+ */
+void trace_emit(uint32_t event, uint32_t a, uint32_t b);
+
+/**
+ * @brief Print the binary ring contents (oldest first) as text.
+ *
+ * Call from task context; does nothing in text mode.
+ */
+void trace_dump(void);
+
+#if TRACE_LEVEL >= TRACE_ERROR
+#define TRACE_ERR(ev, a, b) trace_emit((ev), (uint32_t)(uintptr_t)(a), (uint32_t)(uintptr_t)(b))
+#else
+#define TRACE_ERR(ev, a, b) ((void)0)
+#endif
+
+#if TRACE_LEVEL >= TRACE_DEBUG
+#define TRACE_DBG(ev, a, b) trace_emit((ev), (uint32_t)(uintptr_t)(a), (uint32_t)(uintptr_t)(b))
+#else
+#define TRACE_DBG(ev, a, b) ((void)0)
+#endif
+
+#endif // TRACE_H
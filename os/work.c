@@ -0,0 +1,50 @@
+#include "kernel.h"
+#include "queue.h"
+#include "work.h"
+#include "critical.h"
+
+/*
+ * One producer at a time: with IRQ_NEST a handler can be interrupted by
+ * a higher-priority one, so the post path masks IRQs itself (irq_save()
+ * nests). The worker is the only consumer.
+ */
+QUEUE_DEFINE(work_queue, sizeof(work_t *), WORK_QUEUE_SIZE);
+
+/* --- Worker: run items with IRQs enabled --- */
+static void worker(void) {
+    for (;;) {
+        work_t **slot = queue_recv_wait(&work_queue, 0);
+        work_t *w = *slot;
+        queue_release(&work_queue);
+
+        w->pending = 0;     // may be posted again from here on
+        w->fn(w->arg);
+    }
+}
+
+int work_init(uint8_t priority) {
+    return task_create(worker, NULL, 0, priority) ? 0 : -1;
+}
+
+/* --- Posting: any context, masks around the reserve/commit pair --- */
+int work_post_isr(work_t *w) {
+    int rc = 0;
+
+    irq_flags_t flags = irq_save();
+    if (!w->pending) {
+        work_t **slot = queue_reserve(&work_queue);
+        if (slot) {
+            *slot = w;
+            w->pending = 1;
+            queue_commit_isr(&work_queue);
+        } else {
+            rc = -1;
+        }
+    }
+    irq_restore(flags);
+    return rc;
+}
+
+int work_post(work_t *w) {
+    return work_post_isr(w);
+}
@@ -0,0 +1,58 @@
+#ifndef WORK_H
+#define WORK_H
+
+#include <stdint.h>
+
+/**
+ * @file work.h
+ * @brief Deferred interrupt work (bottom halves).
+ *
+ * An ISR does the minimum with IRQs masked (acknowledge the device, grab
+ * the data) and posts a work item; a kernel worker task runs the item's
+ * function later with IRQs enabled, so other VIC sources are not held
+ * off by slow processing.
+ *
+ * Items are queued by pointer on a ring (see queue.h) and run once per
+ * post, in post order. Posting masks IRQs for the few instructions that
+ * claim a slot, so a nested handler cannot race it. An item that is
+ * already queued is not queued twice; it may be posted again as soon as
+ * its function starts.
+ */
+
+/* Items queued at once (power of two) */
+#define WORK_QUEUE_SIZE 32U
+
+typedef struct work {
+    void (*fn)(void *arg);
+    void *arg;
+    volatile uint8_t pending;   // on the queue, not yet started
+} work_t;
+
+#define WORK_INIT(fn, arg) { (fn), (arg), 0 }
+
+/**
+ * @brief Create the worker task.
+ *
+ * Call once after scheduler_init(). Priority 0 runs deferred work ahead
+ * of every task, right after the posting IRQ returns.
+ *
+ * @return 0 on success, -1 if the task could not be created.
+ */
+int work_init(uint8_t priority);
+
+/**
+ * @brief Queue a work item from IRQ context.
+ *
+ * Masks IRQs around the queue update, so nested handlers (IRQ_NEST) may
+ * post concurrently.
+ *
+ * @return 0 if queued (or already pending), -1 if the queue is full.
+ */
+int work_post_isr(work_t *w);
+
+/**
+ * @brief work_post_isr() for task context.
+ */
+int work_post(work_t *w);
+
+#endif // WORK_H
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include "kernel.h"
+#include "scheduler.h"
+#include "sync.h"
+#include "sim.h"
+
+/*-----------------------------------------------------------------
+  Scheduler core throughput on the host (`make host-bench`)
+
+  Same output format as bench/bench.c:
+    BENCH <name> iters=<n> total_us=<t> ns_per_op=<x>
+  Host numbers are for spotting regressions between two builds on the
+  same machine, not for comparing with the target.
+-----------------------------------------------------------------*/
+#define READY_ROUNDS    (200000U)
+#define SWITCH_ITERS    (1000000U)
+#define TICK_ITERS      (20000U)
+
+static void report(const char *name, uint32_t variant, uint32_t iters, uint32_t total_us) {
+    printf("BENCH %s", name);
+    if (variant != (uint32_t)-1) printf("%u", variant);
+    printf(" iters=%u total_us=%u ns_per_op=%u\n", iters, total_us,
+           (uint32_t)((uint64_t)total_us * 1000U / iters));
+}
+
+static void task_body(void) {
+}
+
+static void boot(void) {
+    sim_reset();
+    scheduler_init(NULL);
+}
+
+/* --- ready_enqueue()/pick_next_task() over all 32 priorities --- */
+static void bench_ready(void) {
+    boot();
+    report("ready_enqueue_pick", (uint32_t)-1, READY_ROUNDS * 32, sched_bench_ready(READY_ROUNDS));
+}
+
+/* --- yield() between two equal-priority tasks --- */
+static void bench_yield(void) {
+    boot();
+    task_create(task_body, NULL, 0, 1);
+    task_create(task_body, NULL, 0, 1);
+    scheduler_start();
+
+    uint32_t start = timestamp_us();
+    for (uint32_t i = 0; i < SWITCH_ITERS; i++) yield();
+    report("switch_yield", (uint32_t)-1, SWITCH_ITERS, timestamp_us() - start);
+}
+
+/* --- Semaphore hand-off: each post wakes the peer, each wait blocks --- */
+static void bench_sem(void) {
+    static sem_t ping = SEM_INIT(0), pong = SEM_INIT(0);
+
+    boot();
+    task_t *a = task_create(task_body, NULL, 0, 1);
+    task_create(task_body, NULL, 0, 1);
+    scheduler_start();
+
+    uint32_t start = timestamp_us();
+    for (uint32_t i = 0; i < SWITCH_ITERS; i++) {
+        int is_a = sched_current() == a;
+        sem_post(is_a ? &pong : &ping);
+        sem_wait(is_a ? &ping : &pong);
+    }
+    report("switch_sem", (uint32_t)-1, SWITCH_ITERS, timestamp_us() - start);
+}
+
+/* --- One tick waking n sleepers, each going back to sleep --- */
+static void bench_tick_wake(uint32_t sleepers) {
+    boot();
+    for (uint32_t i = 0; i < sleepers; i++) task_create(task_body, NULL, 0, 2);
+    scheduler_start();
+
+    const task_t *idle = sched_idle_task();
+    uint32_t start = timestamp_us();
+    for (uint32_t i = 0; i < TICK_ITERS; i++) {
+        while (sched_current() != idle) sleep(1);
+        sim_tick();
+    }
+    report("tick_wake_s", sleepers, TICK_ITERS, timestamp_us() - start);
+}
+
+int main(void) {
+    bench_ready();
+    bench_yield();
+    bench_sem();
+    bench_tick_wake(1);
+    bench_tick_wake(16);
+    bench_tick_wake(256);
+    printf("BENCH DONE\n");
+    return 0;
+}
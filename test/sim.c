@@ -0,0 +1,151 @@
+#include <setjmp.h>
+#include <stdio.h>
+#include <time.h>
+#include "kernel.h"
+#include "arch.h"
+#include "uart.h"
+#include "sim.h"
+
+/* Kernel heap (linker.ld on the target), 32 MiB like the board's RAM */
+#define SIM_HEAP_BYTES 33554432
+#define SIM_STR(x)  SIM_XSTR(x)
+#define SIM_XSTR(x) #x
+__asm__(".data\n"
+        ".balign 64\n"
+        ".globl __heap_start\n"
+        "__heap_start: .space " SIM_STR(SIM_HEAP_BYTES) "\n"
+        ".globl __heap_end\n"
+        "__heap_end:\n"
+        ".text\n");
+
+extern volatile task_t *svc_switch_from;
+extern volatile task_t *svc_switch_to;
+extern void svc_handler(void);
+
+static struct {
+    int masked;         // CPSR I bit
+    int in_irq;         // exception mode
+    uint32_t period;    // ticks per Timer0 expiry
+    uint32_t into_us;   // time into the period, for tick_timer_elapsed_us()
+    jmp_buf *parked;    // sim_noreturn() in progress
+} cpu;
+
+void sim_reset(void) {
+    cpu.masked = 1;     // as from reset until the first task
+    cpu.in_irq = 0;
+    cpu.period = 1;
+    cpu.into_us = 0;
+}
+
+/* Exception exit: startup.S switches when the two differ */
+static void exit_path(void) {
+    svc_switch_from = svc_switch_to;
+}
+
+void sim_irq(void (*handler)(void)) {
+    int masked = cpu.masked;
+
+    cpu.masked = 1;
+    cpu.in_irq = 1;
+    handler();
+    cpu.in_irq = 0;
+    exit_path();
+    cpu.masked = masked;
+}
+
+void sim_tick(void) {
+    cpu.into_us = 0;    // a new period starts at the expiry
+    sim_irq(scheduler_tick);
+}
+
+void sim_noreturn(void (*fn)(void)) {
+    jmp_buf parked;
+
+    cpu.parked = &parked;
+    if (!setjmp(parked)) fn();
+    cpu.parked = NULL;
+    cpu.masked = 0;     // the CPSR of the task switched to
+}
+
+void sim_tick_elapsed(uint32_t us) {
+    cpu.into_us = us;
+}
+
+uint32_t sim_timer_period(void) {
+    return cpu.period;
+}
+
+int sim_irqs_masked(void) {
+    return cpu.masked;
+}
+
+/* --- arch.h / critical.h --- */
+irq_flags_t irq_save(void) {
+    irq_flags_t flags = (irq_flags_t)cpu.masked;
+    cpu.masked = 1;
+    return flags;
+}
+
+void irq_restore(irq_flags_t flags) {
+    cpu.masked = (int)flags;
+}
+
+int arch_in_exception(void) {
+    return cpu.in_irq;
+}
+
+void arch_syscall(void) {
+    // SVC entry masks IRQs; the exit restores the caller's CPSR
+    int masked = cpu.masked;
+    cpu.masked = 1;
+    svc_handler();
+    exit_path();
+    cpu.masked = masked;
+}
+
+void context_start(void) {
+    exit_path();
+    cpu.masked = 0;     // the first task's CPSR
+}
+
+void cpu_wait(void) {
+    if (cpu.parked) longjmp(*cpu.parked, 1);
+}
+
+/* --- Board hooks (scheduler.h) --- */
+void tick_timer_init(uint32_t hz) {
+    (void)hz;
+    cpu.period = 1;
+}
+
+uint32_t tick_timer_elapsed_us(void) {
+    return cpu.into_us;
+}
+
+uint32_t tick_timer_set(uint32_t ticks) {
+    cpu.period = ticks;
+    return 0;   // expiries are instantaneous: no part of a period has elapsed
+}
+
+uint32_t timestamp_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000U + (uint64_t)ts.tv_nsec / 1000U);
+}
+
+/* --- UART (stats, trace and boot output) --- */
+void uart_putc(char c) {
+    if (c != '\r') putchar(c);
+}
+
+void uart_puts(const char *s) {
+    while (*s) uart_putc(*s++);
+}
+
+void uart_puthex(uint32_t value) {
+    printf("0x%08X", value);
+}
+
+void uart_putdec(uint32_t value) {
+    printf("%u", value);
+}
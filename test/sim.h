@@ -0,0 +1,61 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+
+/**
+ * @file sim.h
+ * @brief Host simulation of the CPU and board under the scheduler core.
+ *
+ * Built with SCHED_HOST (`make test`, `make host-bench`). Task code is not
+ * executed: the test program acts on behalf of whatever sched_current()
+ * is, and a context switch just changes which task that is. A blocking
+ * call (sem_wait(), sleep(), ...) therefore returns at once, with the
+ * caller already blocked and the next task current.
+ *
+ * IRQ masking is a flag, the SVC trap calls svc_handler() directly and
+ * sim_tick() runs scheduler_tick() the way the Timer0 IRQ would.
+ */
+
+/**
+ * @brief Reset the simulated CPU: IRQs masked, thread mode, Timer0 idle.
+ * Call before scheduler_init().
+ */
+void sim_reset(void);
+
+/**
+ * @brief One Timer0 expiry: scheduler_tick() in IRQ context, followed by
+ * the switch the exception exit path would perform.
+ */
+void sim_tick(void);
+
+/**
+ * @brief Run a handler in IRQ context (e.g. one calling sem_post_isr()).
+ */
+void sim_irq(void (*handler)(void));
+
+/**
+ * @brief Make a call that does not return (task_exit()) on behalf of the
+ * current task. It comes back once the call has switched away and parked
+ * in cpu_wait(); the new current task runs with IRQs enabled.
+ */
+void sim_noreturn(void (*fn)(void));
+
+/**
+ * @brief Set what tick_timer_elapsed_us() reports: how far into the
+ * current period the simulated time is (expiries still happen only on
+ * sim_tick()).
+ */
+void sim_tick_elapsed(uint32_t us);
+
+/**
+ * @brief Ticks the last tick_timer_set() programmed (tickless period).
+ */
+uint32_t sim_timer_period(void);
+
+/**
+ * @brief Whether IRQs are currently masked.
+ */
+int sim_irqs_masked(void);
+
+#endif // SIM_H
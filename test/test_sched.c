@@ -0,0 +1,661 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "kernel.h"
+#include "scheduler.h"
+#include "sync.h"
+#include "event.h"
+#include "swtimer.h"
+#include "queue.h"
+#include "sim.h"
+
+/*-----------------------------------------------------------------
+  Scheduler core tests (`make test`, `make test TEST_SEED=<n>`)
+
+  Each test boots a fresh scheduler on the simulated CPU (see sim.h)
+  and then acts as whatever task is current. Exit status is the number
+  of failed checks.
+-----------------------------------------------------------------*/
+#define TEST_STACK_WORDS    (64U)
+
+#define STRESS_TASKS        (2000U)     // live at most
+#define STRESS_EVENTS       (200000U)
+#define STRESS_SEMS         (8U)
+#define STRESS_VERIFY_EVERY (16U)
+
+static int failures;
+
+#define CHECK(cond)                                                   \
+    do {                                                              \
+        if (!(cond)) {                                                \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                               \
+        }                                                             \
+    } while (0)
+
+/* Task entry: never executed in the simulation */
+static void task_body(void) {
+}
+
+static void boot(const sched_config_t *cfg) {
+    sim_reset();
+    scheduler_init(cfg);
+}
+
+static task_t *spawn(uint8_t priority) {
+    return task_create(task_body, NULL, TEST_STACK_WORDS, priority);
+}
+
+/* No ready task may outrank the running one (sched_lock() aside) */
+static int current_is_best(void) {
+    task_t *curr = sched_current();
+    for (task_t *t = sched_task_list(); t; t = t->all_next)
+        if (t->state == TASK_READY && t->priority < curr->priority) return 0;
+    return 1;
+}
+
+/* After a tick nothing may still sleep past its wakeup */
+static int no_missed_wakeup(void) {
+    uint32_t now = sched_tick_raw();
+    for (task_t *t = sched_task_list(); t; t = t->all_next)
+        if (t->state == TASK_SLEEPING && (int32_t)(t->wake_tick - now) <= 0) return 0;
+    return 1;
+}
+
+/* --- Ready list invariants under random enqueue/dequeue/pick --- */
+static void test_selftest(void) {
+    boot(NULL);
+    CHECK(sched_selftest() == 0);
+}
+
+/* --- Priority preemption: create, block, wake from an IRQ --- */
+static sem_t preempt_sem = SEM_INIT(0);
+
+static void post_preempt_sem(void) {
+    sem_post_isr(&preempt_sem);
+}
+
+static void test_preempt(void) {
+    boot(NULL);
+    task_t *a = spawn(5);
+    scheduler_start();
+    CHECK(sched_current() == a);
+    CHECK(!sim_irqs_masked());
+
+    task_t *b = spawn(2);
+    CHECK(sched_current() == b);
+    spawn(9);
+    CHECK(sched_current() == b);
+
+    sem_wait(&preempt_sem);     // b blocks
+    CHECK(b->state == TASK_BLOCKED);
+    CHECK(sched_current() == a);
+
+    sim_irq(post_preempt_sem);
+    CHECK(sched_current() == b);
+    CHECK(a->state == TASK_READY);
+    CHECK(sched_verify_tasks() == 0);
+}
+
+/* --- Round-robin: equal priorities rotate when the quantum runs out --- */
+static void test_round_robin(void) {
+    boot(NULL);     // quantum 1
+    task_t *t[3];
+    for (int i = 0; i < 3; i++) t[i] = spawn(4);
+    scheduler_start();
+
+    for (int n = 0; n < 7; n++) {
+        CHECK(sched_current() == t[n % 3]);
+        sim_tick();
+    }
+
+    sched_config_t cfg = { 0 };
+    cfg.quantum[4] = 3;
+    boot(&cfg);
+    task_t *a = spawn(4), *b = spawn(4);
+    scheduler_start();
+    CHECK(sched_current() == a);
+
+    // A busy task is never stretched: a keeps ticks 1 and 2, b gets 3
+    sim_tick();
+    sim_tick();
+    CHECK(sched_current() == a);
+    CHECK(sim_timer_period() == 1);
+    sim_tick();
+    CHECK(sched_tick_raw() == 3);
+    CHECK(sched_current() == b);
+    CHECK(sched_verify_tasks() == 0);
+}
+
+/* --- Sleep queue: wake in wake_tick order, timer stretched between --- */
+static uint32_t isr_ticks;
+
+static void read_ticks_isr(void) {
+    isr_ticks = scheduler_ticks();
+}
+
+static void test_sleep_order(void) {
+    boot(NULL);
+    task_t *a = spawn(1), *b = spawn(2), *c = spawn(3);
+    scheduler_start();
+
+    sleep(30);      // a
+    sleep(10);      // b
+    sleep(20);      // c
+    CHECK(sched_current() == sched_idle_task());
+    CHECK(sim_timer_period() == 10);
+    CHECK(sched_verify_tasks() == 0);
+
+    // An IRQ reads the ticks gone so far without ending the period
+    sim_tick_elapsed(3500);
+    sim_irq(read_ticks_isr);
+    CHECK(isr_ticks == 3);
+    CHECK(sim_timer_period() == 10);
+
+    sim_tick();
+    CHECK(sched_tick_raw() == 10);
+    CHECK(sched_current() == b);
+    sleep(100);
+
+    sim_tick();
+    CHECK(sched_tick_raw() == 20);
+    CHECK(sched_current() == c);
+    sleep(100);
+
+    sim_tick();
+    CHECK(sched_tick_raw() == 30);
+    CHECK(sched_current() == a);
+    CHECK(no_missed_wakeup());
+    CHECK(sched_verify_tasks() == 0);
+}
+
+/* --- sleep_until() in the past, sleep_us() counting the partial tick --- */
+static void test_sleep_until_us(void) {
+    boot(NULL);     // 1000 Hz: 1000 us per tick
+    task_t *a = spawn(1);
+    scheduler_start();
+    sim_tick();
+    sim_tick();
+
+    sleep_until(1);     // passed
+    CHECK(sched_current() == a);
+    sleep_until(2);     // now
+    CHECK(sched_current() == a);
+    CHECK(a->state == TASK_RUNNING);
+
+    sleep_until(5);
+    CHECK(a->state == TASK_SLEEPING);
+    CHECK(sim_timer_period() == 3);
+    sim_tick();
+    CHECK(sched_tick_raw() == 5);
+    CHECK(sched_current() == a);
+
+    // 600 us into tick 5: 1500 us ends 100 us into tick 7
+    sim_tick_elapsed(600);
+    sleep_us(1500);
+    CHECK(a->state == TASK_SLEEPING);
+    CHECK(a->wake_tick == 7);
+    sim_tick();
+    CHECK(sched_current() == a);
+
+    // At the boundary: one whole tick, then 500 us spun
+    sleep_us(1500);
+    CHECK(a->wake_tick == 8);
+    sim_tick();
+    CHECK(sched_current() == a);
+
+    // Under a tick: spun, never blocked
+    sleep_us(500);
+    CHECK(sched_current() == a);
+    CHECK(a->state == TASK_RUNNING);
+    CHECK(sched_verify_tasks() == 0);
+}
+
+/* --- Periodic tasks: EDF order, release on time, overruns counted --- */
+static void test_periodic_edf(void) {
+    sched_config_t cfg = { 0 };
+    cfg.edf_levels = 1u << 3;
+    for (int p = 0; p < 32; p++) cfg.quantum[p] = 1;
+    boot(&cfg);
+    task_t *a = task_create_periodic(task_body, NULL, TEST_STACK_WORDS, 3, 20, 0);
+    task_t *b = task_create_periodic(task_body, NULL, TEST_STACK_WORDS, 3, 5, 0);
+    task_period_stats_t st;
+    CHECK(task_period_stats(spawn(4), &st) == -1);
+    CHECK(task_create_periodic(task_body, NULL, TEST_STACK_WORDS, 3, 0, 0) == NULL);
+    scheduler_start();
+
+    // Both released at tick 0: b's deadline (5) comes first
+    CHECK(sched_current() == b);
+    sched_periodic_job_done();
+    CHECK(b->state == TASK_SLEEPING);
+    CHECK(b->release == 5);
+    CHECK(sched_current() == a);
+
+    // b's release (deadline 10) preempts a (deadline 20), time slice or not
+    for (int n = 0; n < 5; n++) sim_tick();
+    CHECK(sched_tick_raw() == 5);
+    CHECK(sched_current() == b);
+    CHECK(a->state == TASK_READY);
+    sim_tick();
+    CHECK(sched_current() == b);
+
+    // b overruns to tick 16: one miss, the releases at 10 and 15 skipped
+    for (int n = 0; n < 10; n++) sim_tick();
+    CHECK(sched_tick_raw() == 16);
+    sched_periodic_job_done();
+    CHECK(task_period_stats(b, &st) == 0);
+    CHECK(st.jobs == 2);
+    CHECK(st.deadline_misses == 1);
+    CHECK(st.skipped == 2);
+    CHECK(b->release == 20);
+    CHECK(b->abs_deadline == 25);
+    CHECK(sched_current() == a);
+
+    // a finishes on time; both are released again at 20, b first
+    sched_periodic_job_done();
+    CHECK(task_period_stats(a, &st) == 0);
+    CHECK(st.jobs == 1);
+    CHECK(st.deadline_misses == 0);
+    CHECK(a->release == 20);
+    while (sched_tick_raw() < 20) sim_tick();
+    CHECK(sched_current() == b);
+    CHECK(a->state == TASK_READY);
+    CHECK(sched_verify_tasks() == 0);
+}
+
+/* --- Stack check: the canary, and room for the frame saved above it --- */
+static void test_stack_check(void) {
+    static uint32_t stack_a[TEST_STACK_WORDS], stack_b[TEST_STACK_WORDS];
+
+    boot(NULL);
+    task_t *a = task_create(task_body, stack_a, TEST_STACK_WORDS, 1);
+    task_t *b = task_create(task_body, stack_b, TEST_STACK_WORDS, 1);
+    scheduler_start();
+    CHECK(sched_current() == a);
+
+    // a ran down to 17 words above its canary: a 17-word frame saved
+    // from there lands on it
+    stack_a[17] = 0;
+    yield();
+    CHECK(sched_current() == b);
+    CHECK(a->flags & TASK_STACK_OVF);
+    CHECK(!(b->flags & TASK_STACK_OVF));
+
+    stack_b[0] = 0;
+    yield();
+    CHECK(sched_current() == a);
+    CHECK(b->flags & TASK_STACK_OVF);
+}
+
+/* --- sched_lock(): preemption deferred to the outermost unlock --- */
+static void test_sched_lock(void) {
+    boot(NULL);
+    task_t *a = spawn(5);
+    scheduler_start();
+
+    sched_lock();
+    CHECK(!sim_irqs_masked());
+    task_t *b = spawn(1);
+    CHECK(sched_current() == a);
+    sim_tick();
+    CHECK(sched_current() == a);
+
+    sched_lock();
+    sched_unlock();
+    CHECK(sched_current() == a);
+
+    sched_unlock();
+    CHECK(sched_current() == b);
+    CHECK(sched_verify_tasks() == 0);
+}
+
+/* --- Event groups: wait for all, and give up on timeout --- */
+static void test_event(void) {
+    static event_group_t g = EVENT_GROUP_INIT;
+
+    boot(NULL);
+    task_t *a = spawn(3), *b = spawn(4);
+    scheduler_start();
+
+    event_wait(&g, 0x3, EVENT_WAIT_ALL, 0);     // a
+    CHECK(sched_current() == b);
+    event_set(&g, 0x1);
+    CHECK(sched_current() == b);
+    event_set(&g, 0x2);
+    CHECK(sched_current() == a);
+    CHECK(a->wait_bits == 0x3);
+    event_clear(&g, 0x3);
+
+    event_wait(&g, 0x4, 0, 5);                  // a, 5 ticks
+    CHECK(sched_current() == b);
+    for (int n = 0; n < 4; n++) sim_tick();
+    CHECK(sched_current() == b);
+    sim_tick();
+    CHECK(sched_tick_raw() == 5);
+    CHECK(sched_current() == a);
+    CHECK(a->wait_result == SCHED_WAIT_TIMEOUT);
+    CHECK(sched_verify_tasks() == 0);
+}
+
+/* --- Mutexes: inheritance through a chain, and back down on unlock --- */
+static void test_mutex_pi(void) {
+    static mutex_t m1 = MUTEX_INIT, m2 = MUTEX_INIT;
+
+    boot(NULL);
+    task_t *low = spawn(10);
+    scheduler_start();
+    mutex_lock(&m1);                // low
+
+    task_t *mid = spawn(6);
+    mutex_lock(&m2);                // mid
+    mutex_lock(&m1);                // mid blocks, boosts low
+    CHECK(sched_current() == low);
+    CHECK(low->priority == 6);
+
+    task_t *high = spawn(2);
+    mutex_lock(&m2);                // high blocks, boosts mid and low
+    CHECK(sched_current() == low);
+    CHECK(mid->priority == 2 && low->priority == 2);
+
+    mutex_unlock(&m1);              // to mid, low drops back
+    CHECK(m1.owner == mid && mid->state == TASK_RUNNING);
+    CHECK(low->priority == 10);
+    CHECK(mid->priority == 2);
+
+    mutex_unlock(&m2);              // to high, mid keeps m1 at its base
+    CHECK(m2.owner == high && sched_current() == high);
+    CHECK(mid->priority == 6 && mid->held == &m1);
+    CHECK(sched_verify_tasks() == 0);
+}
+
+/* --- Mutexes: unlock hands over to the best waiter, FIFO among equals --- */
+static void test_mutex_handoff(void) {
+    static mutex_t m = MUTEX_INIT;
+
+    boot(NULL);
+    task_t *owner = spawn(10);
+    scheduler_start();
+    mutex_lock(&m);
+
+    task_t *w[3];
+    const uint8_t prio[3] = { 5, 3, 3 };
+    for (int i = 0; i < 3; i++) {
+        w[i] = spawn(prio[i]);
+        if (i == 2) yield();        // level with the boosted owner: its turn
+        mutex_lock(&m);
+        CHECK(sched_current() == owner);
+    }
+    CHECK(owner->priority == 3);
+
+    mutex_unlock(&m);
+    CHECK(m.owner == w[1] && sched_current() == w[1]);
+    CHECK(owner->priority == 10);
+    CHECK(m.waiters.head == w[2] && w[0]->state == TASK_BLOCKED);
+    CHECK(sched_verify_tasks() == 0);
+}
+
+/* --- Mutexes: no owner left dangling by task_delete()/task_exit() --- */
+static void test_mutex_stop(void) {
+    static mutex_t m = MUTEX_INIT;
+
+    // Deleting the owner passes the mutex on; its TCB is then recycled
+    boot(NULL);
+    task_t *owner = spawn(10);
+    scheduler_start();
+    mutex_lock(&m);
+    task_t *waiter = spawn(4);
+    mutex_lock(&m);
+    task_t *killer = spawn(1);
+    CHECK(task_delete(owner) == 0);
+    CHECK(sched_current() == killer);
+    CHECK(m.owner == waiter && waiter->state == TASK_READY && waiter->held == &m);
+    task_t *fresh = spawn(20);
+    CHECK(fresh->held == NULL && m.owner == waiter);
+    CHECK(sched_verify_tasks() == 0);
+
+    // Deleting the only waiter takes back the boost it gave
+    static mutex_t m2 = MUTEX_INIT;
+    boot(NULL);
+    owner = spawn(10);
+    scheduler_start();
+    mutex_lock(&m2);
+    waiter = spawn(2);
+    mutex_lock(&m2);
+    CHECK(owner->priority == 2);
+    spawn(1);
+    CHECK(task_delete(waiter) == 0);
+    CHECK(owner->priority == 10 && m2.waiters.head == NULL && m2.owner == owner);
+    CHECK(sched_verify_tasks() == 0);
+
+    // An owner that exits hands over as well
+    static mutex_t m3 = MUTEX_INIT;
+    boot(NULL);
+    owner = spawn(10);
+    scheduler_start();
+    mutex_lock(&m3);
+    waiter = spawn(4);
+    mutex_lock(&m3);
+    CHECK(sched_current() == owner);
+    sim_noreturn(task_exit);
+    CHECK(owner->state == TASK_STOPPED);
+    CHECK(m3.owner == waiter && sched_current() == waiter);
+    CHECK(!sim_irqs_masked());
+    CHECK(sched_verify_tasks() == 0);
+}
+
+/* --- Queues: a blocked consumer times out, or wakes on commit --- */
+QUEUE_DEFINE(test_queue, sizeof(uint32_t), 4);
+
+static void test_queue_timeout(void) {
+    boot(NULL);
+    task_t *rx = spawn(3), *tx = spawn(4);
+    scheduler_start();
+
+    queue_recv_wait(&test_queue, 5);    // rx
+    CHECK(rx->state == TASK_BLOCKED && sched_current() == tx);
+    for (int n = 0; n < 4; n++) sim_tick();
+    CHECK(rx->state == TASK_BLOCKED);
+    sim_tick();
+    CHECK(sched_current() == rx);
+    CHECK(rx->wait_result == SCHED_WAIT_TIMEOUT);
+
+    queue_recv_wait(&test_queue, 10);   // rx
+    CHECK(sched_current() == tx);
+    uint32_t *slot = queue_reserve(&test_queue);
+    *slot = 42;
+    queue_commit(&test_queue);
+    CHECK(sched_current() == rx);
+    CHECK(rx->wait_result == SCHED_WAIT_OK);
+    slot = queue_peek(&test_queue);
+    CHECK(slot && *slot == 42);
+    queue_release(&test_queue);
+
+    // The timeout was cancelled with the wakeup
+    for (int n = 0; n < 12; n++) sim_tick();
+    CHECK(rx->wait_result == SCHED_WAIT_OK);
+    CHECK(sched_verify_tasks() == 0);
+}
+
+/* --- Software timers: expiries cap the tickless period --- */
+static void timer_fn(void *arg) {
+    (void)arg;
+}
+
+static void test_swtimer(void) {
+    static swtimer_t once = SWTIMER_INIT(timer_fn, NULL);
+    static swtimer_t every = SWTIMER_INIT(timer_fn, NULL);
+
+    boot(NULL);
+    spawn(1);
+    scheduler_start();
+
+    swtimer_start(&once, 7, 0);
+    sleep(100);
+    CHECK(sim_timer_period() == 7);
+    sim_tick();
+    CHECK(sched_tick_raw() == 7);
+    CHECK(!once.armed && once.pending);     // handed to the service task
+
+    // Starting leaves the stretched period: one plain tick, then 5-tick ones
+    swtimer_start(&every, 5, 5);
+    int ticks = 0;
+    while (sched_tick_raw() < 22) {
+        sim_tick();
+        ticks++;
+    }
+    CHECK(sched_tick_raw() == 22);
+    CHECK(ticks == 4);
+    CHECK(swtimer_active(&every));
+    swtimer_stop(&every);
+    CHECK(!swtimer_active(&every));
+
+    // Beyond one wheel turn the idle period still runs to the expiry
+    static swtimer_t far = SWTIMER_INIT(timer_fn, NULL);
+    static swtimer_t near = SWTIMER_INIT(timer_fn, NULL);
+    boot(NULL);
+    spawn(1);
+    scheduler_start();
+    swtimer_start(&far, 200 + SWTIMER_WHEEL_SLOTS, 0);
+    swtimer_start(&near, SWTIMER_WHEEL_SLOTS, 0);
+    sleep(2000);
+    CHECK(sim_timer_period() == SWTIMER_WHEEL_SLOTS);
+    sim_tick();
+    CHECK(!near.armed && near.pending);
+    CHECK(sim_timer_period() == 200);
+    sim_tick();
+    CHECK(sched_tick_raw() == 200 + SWTIMER_WHEEL_SLOTS);
+    CHECK(!far.armed && far.pending);
+}
+
+/*
+ * --- Randomised stress ---
+ * Thousands of tasks at random priorities; each event is a tick, an IRQ
+ * posting a semaphore, or a call made by whichever task is current.
+ */
+static uint32_t seed;
+
+static uint32_t rnd(void) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+static sem_t stress_sems[STRESS_SEMS];
+static sem_t *irq_sem;
+
+static void post_irq_sem(void) {
+    sem_post_isr(irq_sem);
+}
+
+static void test_stress(uint32_t start_seed) {
+    static task_t *live[STRESS_TASKS];
+    uint32_t n_live = 0, created = 0, deleted = 0, ticks = 0;
+
+    seed = start_seed ? start_seed : 1;
+    for (uint32_t i = 0; i < STRESS_SEMS; i++) sem_init(&stress_sems[i], 0);
+
+    boot(NULL);
+    for (; n_live < STRESS_TASKS / 2; n_live++, created++) live[n_live] = spawn(rnd() % 32);
+    scheduler_start();
+
+    for (uint32_t ev = 0; ev < STRESS_EVENTS; ev++) {
+        uint32_t r = rnd();
+        int idle = sched_current() == sched_idle_task();
+        sem_t *s = &stress_sems[(r >> 8) % STRESS_SEMS];
+
+        switch (r % 100) {
+        case 0 ... 9:
+            sim_tick();
+            ticks++;
+            if (!no_missed_wakeup()) {
+                printf("stress: missed wakeup at tick %u (event %u)\n", sched_tick_raw(), ev);
+                failures++;
+                return;
+            }
+            break;
+        case 10 ... 19:
+            irq_sem = s;
+            sim_irq(post_irq_sem);
+            break;
+        case 20 ... 31:
+            if (n_live < STRESS_TASKS) {
+                task_t *t = spawn((r >> 16) % 32);
+                CHECK(t != NULL);
+                if (!t) return;
+                live[n_live++] = t;
+                created++;
+            }
+            break;
+        case 32 ... 41:
+            if (n_live) {
+                uint32_t i = (r >> 12) % n_live;
+                if (live[i] == sched_current()) break;
+                CHECK(task_delete(live[i]) == 0);
+                live[i] = live[--n_live];
+                deleted++;
+            }
+            break;
+        case 42 ... 59:
+            if (!idle) sleep(1 + (r >> 16) % 50);
+            break;
+        case 60 ... 69:
+            if (!idle) yield();
+            break;
+        case 70 ... 84:
+            if (!idle) sem_wait(s);
+            break;
+        default:
+            if (!idle) sem_post(s);
+            break;
+        }
+
+        if (sim_irqs_masked()) {
+            printf("stress: IRQs left masked (event %u)\n", ev);
+            failures++;
+            return;
+        }
+        if (ev % STRESS_VERIFY_EVERY == 0 && (sched_verify_tasks() || !current_is_best())) {
+            printf("stress: invariant broken (event %u, seed %u)\n", ev, start_seed);
+            failures++;
+            return;
+        }
+    }
+
+    printf("stress: seed=%u events=%u ticks=%u (%u simulated) created=%u deleted=%u live=%u\n",
+           start_seed, STRESS_EVENTS, ticks, sched_tick_raw(), created, deleted, n_live);
+}
+
+/*-----------------------------------------------------------------
+  Main
+-----------------------------------------------------------------*/
+static void run(const char *name, void (*fn)(void)) {
+    int before = failures;
+    fn();
+    printf("%s %s\n", failures == before ? "PASS" : "FAIL", name);
+}
+
+int main(int argc, char **argv) {
+    uint32_t stress_seed = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 1;
+
+    run("selftest", test_selftest);
+    run("preempt", test_preempt);
+    run("round_robin", test_round_robin);
+    run("sleep_order", test_sleep_order);
+    run("sleep_until_us", test_sleep_until_us);
+    run("periodic_edf", test_periodic_edf);
+    run("stack_check", test_stack_check);
+    run("sched_lock", test_sched_lock);
+    run("event", test_event);
+    run("mutex_pi", test_mutex_pi);
+    run("mutex_handoff", test_mutex_handoff);
+    run("mutex_stop", test_mutex_stop);
+    run("queue_timeout", test_queue_timeout);
+    run("swtimer", test_swtimer);
+
+    int before = failures;
+    test_stress(stress_seed);
+    printf("%s stress\n", failures == before ? "PASS" : "FAIL");
+
+    printf("%d failure(s)\n", failures);
+    return failures ? 1 : 0;
+}